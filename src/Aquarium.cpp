@@ -39,30 +39,33 @@ void PlayerCreature::move() {
     this->bounce();
 }
 
-void PlayerCreature::reduceDamageDebounce() {
-    if (m_damage_debounce > 0) {
-        --m_damage_debounce;
-    }
+void PlayerCreature::bindTimers(TimerWheel* timers) {
+    m_timers = timers;
+    // nothing to do when the debounce ends, its handle just stops being pending
+    m_timers->SetHandler(static_cast<uint16_t>(GameTimer::SPEED_BOOST), [this](TimerHandle, uint64_t) { this->endSpeedBoost(); });
+}
+
+void PlayerCreature::startSpeedBoost(int ticks) {
+    // a second power-up restarts the clock, the speed it added stays (that's how it always played)
+    m_timers->Cancel(m_speedBoostTimer);
+    m_speedBoostTimer = m_timers->Schedule(ticks, static_cast<uint16_t>(GameTimer::SPEED_BOOST));
+}
+
+void PlayerCreature::endSpeedBoost() {
+    m_speedBoostTimer = TimerHandle{};
+    m_speed = std::max(1, m_speed - 2);
+    if (ShouldLog(OF_LOG_NOTICE)) ofLogNotice() << "Speed boost ended. Speed reset to " << m_speed;
 }
 
 void PlayerCreature::update() {
-    this->reduceDamageDebounce();
-    //checks if speedBoost is active 
-    if (m_speedBoostTimer > 0) {
-        --m_speedBoostTimer; //subtract one from the timer in every frame 
-        if (m_speedBoostTimer == 0) { // Reset speed after boost stops
-            m_speed = std::max(1, m_speed - 2);
-            ofLogNotice() << "Speed boost ended. Speed reset to " << m_speed;
-        }
-    }
-    this->move();
+    this->move(); // the debounce and the speed boost end on the tank's timers
 }
 
 
 void PlayerCreature::draw() const {
     
-    ofLogVerbose() << "PlayerCreature at (" << m_x << ", " << m_y << ") with speed " << m_speed << std::endl;
-    if (this->m_damage_debounce > 0) {
+    if (IsVerboseLogging()) ofLogVerbose() << "PlayerCreature at (" << m_x << ", " << m_y << ") with speed " << m_speed << std::endl;
+    if (this->isDamageDebounce()) {
         ofSetColor(ofColor::red); // Flash red if in damage debounce
     }
     if (m_sprite) {
@@ -77,164 +80,95 @@ void PlayerCreature::changeSpeed(int speed) {
 }
 
 void PlayerCreature::loseLife(int debounce) {
-    if (m_damage_debounce <= 0) {
+    if (!this->isDamageDebounce()) {
         if (m_lives > 0) this->m_lives -= 1;
-        m_damage_debounce = debounce; // Set debounce frames
-        ofLogNotice() << "Player lost a life! Lives remaining: " << m_lives << std::endl;
+        m_damageTimer = m_timers->Schedule(debounce, static_cast<uint16_t>(GameTimer::DAMAGE_DEBOUNCE)); // Set debounce ticks
+        PlaySfx(SfxId::DAMAGE, 1.0f, SfxPan(m_x, m_maxX));
+        if (ShouldLog(OF_LOG_NOTICE)) ofLogNotice() << "Player lost a life! Lives remaining: " << m_lives << std::endl;
     }
 
     //If fish loses a life the power-up will be canceled to make it cleaner 
-    if (m_speedBoostTimer > 0) {
-            m_speedBoostTimer = 0; // stops the timer
+    if (this->isSpeedBoosted()) {
+            m_timers->Cancel(m_speedBoostTimer); // stops the timer
             m_speed = std::max(1, m_speed - 2); // revert speed boost making it go back to normal 
-            ofLogNotice() << "Power-Up canceled due to life loss. Speed reset to " << m_speed;
+            if (ShouldLog(OF_LOG_NOTICE)) ofLogNotice() << "Power-Up canceled due to life loss. Speed reset to " << m_speed;
     }
 
     // If in debounce period, do nothing
-    if (m_damage_debounce > 0) {
-        ofLogVerbose() << "Player is in damage debounce period. Frames left: " << m_damage_debounce << std::endl;
+    if (this->isDamageDebounce()) {
+        if (IsVerboseLogging()) ofLogVerbose() << "Player is in damage debounce period. Ticks left: " << m_timers->GetRemaining(m_damageTimer) << std::endl;
     }
 }
 
 // NPCreature Implementation
 NPCreature::NPCreature(float x, float y, int speed, std::shared_ptr<GameSprite> sprite)
 : Creature(x, y, speed, 30, 1, sprite) {
-    m_dx = (rand() % 3 - 1); 
-    m_dy = (rand() % 3 - 1); 
-    normalize();
-
+    // heading is assigned by Aquarium::SpawnCreature from the tank's generator
     m_creatureType = AquariumCreatureType::NPCreature;
 }
 
-void NPCreature::move() {
-    // Simple AI movement logic (random direction)
-    m_x += m_dx * m_speed;
-    m_y += m_dy * m_speed;
-    if(m_dx < 0 ){
-        this->m_sprite->setFlipped(true);
-    }else {
-        this->m_sprite->setFlipped(false);
-    }
-    bounce();
-}
-
-void NPCreature::draw() const {
-    ofLogVerbose() << "NPCreature at (" << m_x << ", " << m_y << ") with speed " << m_speed << std::endl;
-    ofSetColor(ofColor::white);
-    if (m_sprite) {
-        m_sprite->draw(m_x, m_y);
-    }
-}
-
-
-BiggerFish::BiggerFish(float x, float y, int speed, std::shared_ptr<GameSprite> sprite)
-: NPCreature(x, y, speed, sprite) {
-    m_dx = (rand() % 3 - 1);
-    m_dy = (rand() % 3 - 1);
+void NPCreature::setHeading(float dx, float dy) {
+    m_dx = dx;
+    m_dy = dy;
     normalize();
-
-    setCollisionRadius(60); // Bigger fish have a larger collision radius
-    m_value = 5; // Bigger fish have a higher value
-    m_creatureType = AquariumCreatureType::BiggerFish;
 }
 
-void BiggerFish::move() {
-    // Bigger fish might move slower or have different logic
-    m_x += m_dx * (m_speed * 0.5); // Moves at half speed
-    m_y += m_dy * (m_speed * 0.5);
-    if(m_dx < 0 ){
-        this->m_sprite->setFlipped(true);
-    }else {
-        this->m_sprite->setFlipped(false);
-    }
-
-    bounce();
-}
-
-void BiggerFish::draw() const {
-    ofLogVerbose() << "BiggerFish at (" << m_x << ", " << m_y << ") with speed " << m_speed << std::endl;
-    this->m_sprite->draw(this->m_x, this->m_y);
+void NPCreature::move() {
+    // fish kinds are stepped through their compile-time motion, see FishKinds
+    FishKinds::Step(*this);
 }
 
-//Zaggy fish's logic implementation
-ZaggyFish::ZaggyFish(float x, float y, int speed, std::shared_ptr<GameSprite> sprite) : NPCreature(x, y, speed, sprite) {
-    setCollisionRadius(40);
-    m_value = 4;
-    m_creatureType = AquariumCreatureType::ZaggyFish;
-}
-//movement implementation
-void ZaggyFish::move() {
-    m_x += m_dx * m_speed;
-    m_y += sin(ofGetElapsedTimef() * 5) * 10; // applies zig-zag movement
-    if(m_dx < 0) {
-        m_sprite->setFlipped(true);
-    } else {
-        m_sprite->setFlipped(false);
-    }
-    bounce();
-}
-void ZaggyFish::draw() const {
-    if(m_sprite) {
-        this->m_sprite->draw(this->m_x, this->m_y);
-    }
+void NPCreature::draw() const {
+    this->drawAt(m_x, m_y);
 }
 
-//Slow fish's logic implementation
-Slowfish::Slowfish(float x, float y, int speed, std::shared_ptr<GameSprite> sprite) : NPCreature(x, y, speed, sprite) {
-    setCollisionRadius(50);
-    m_value = 6;
-    m_creatureType = AquariumCreatureType::Slowfish;
-}
-//Movement Implementation
-void Slowfish::move() {
-    m_x += m_dx * (m_speed * 0.25); // Moves slower than the other fish
-    m_y += m_dy * (m_speed * 0.25) + sin(ofGetElapsedTimef() * 2) * 2; //small vertical drift 
-    if(m_dx < 0 ){
-        this->m_sprite->setFlipped(true);
-    }else {
-        this->m_sprite->setFlipped(false);
-    }
-    bounce();
-}
-void Slowfish::draw() const {
-    if(m_sprite) {
-        this->m_sprite->draw(this->m_x, this->m_y);
+void NPCreature::drawAt(float x, float y) const {
+    if (IsVerboseLogging()) ofLogVerbose() << "NPCreature at (" << x << ", " << y << ") with speed " << m_speed << std::endl;
+    ofSetColor(ofColor::white);
+    if (m_sprite) {
+        m_sprite->draw(x, y);
     }
 }
 
 //New boss logic implementation
 BossFish::BossFish(float x, float y, int speed, std::shared_ptr<GameSprite> sprite)
                   : NPCreature(x, y, speed, sprite) {
-    this->health = 4;
+    this->health = kMaxHealth;
     this->m_value = 100;
     setCollisionRadius(80);
-    coolDownAttack = 2.0f;
-    lastAttackTime = 0.0f;
+    coolDownAttack = 720; // 12 s at 60 Hz, what its 2 s think came to when it ran on every 6th tick
+    m_Attacks_Circles.reserve(16); // shots in flight, so shooting doesn't grow it mid-fight
     m_dx = 1; // moves horizontally
     m_dy = 0;
     
     m_creatureType = AquariumCreatureType::BossFish;
 }
 void BossFish::move() { 
+    m_driftTime += kDriftTimeStep;
     m_x += m_dx * m_speed; // moves in revers direction when it hit the edges
-    m_y += sin(ofGetElapsedTimef() * 2.0f) * 2.0f; // slight vertical sinusoidal moves
+    m_y += sin(m_driftTime * 2.0f) * 2.0f; // slight vertical sinusoidal moves
 
-    if(m_dx < 0 ){
-        this->m_sprite->setFlipped(true);
-    }else {
-        this->m_sprite->setFlipped(false);
-    }
+    setFlipped(m_dx < 0);
 
-    // Reverse direction on edges
+    // Reverse direction on edges, m_maxX is the tank width (set on spawn)
     if (m_x < 0) {
         m_x = 0;
         m_dx = -m_dx;
     }
-    if (m_x + 200 > ofGetWidth()) {
-        m_x = ofGetWidth() - 200;
+    if (m_x + 200 > m_maxX) {
+        m_x = m_maxX - 200;
+        m_dx = -m_dx;
+    }
+}
+// which way to patrol is a decision, not physics: turn around when the player is well behind
+void BossFish::think() {
+    if (!m_player) return;
+    float toPlayer = m_player->getX() - (m_x + 100); // from the boss's middle, its sprite is 200 wide
+    if (std::abs(toPlayer) > kTurnDistance && (toPlayer > 0) != (m_dx > 0)) {
         m_dx = -m_dx;
     }
 }
+
 void BossFish::draw() const { //Draws the sprite of Boss fish
     if(m_sprite) {
         this->m_sprite->draw(this->m_x, this->m_y);
@@ -244,25 +178,13 @@ void BossFish::draw() const { //Draws the sprite of Boss fish
     }
 }
 
-void BossFish::update(float dt, bool& playerDied) {
+void BossFish::update(bool& playerDied) {
     playerDied = false; //bool indicating if player died
     move(); //Boss fishe's movement
 
-    // timer for attack spawn
-    lastAttackTime += dt > 0 ? dt : 1.0f / 60.0f;
-    if (lastAttackTime >= coolDownAttack) {
-        shootAttack();
-        lastAttackTime = 0.0f;
-    }
-
     // collision between boss and player
     if (m_player) {
-        float dx = (m_x + 100) - m_player->getX();
-        float dy = (m_y + 100) - m_player->getY();
-        float distance = dx * dx + dy * dy;
-        float radiusSum = getCollisionRadius() + m_player->getCollisionRadius();
-
-        if (distance < radiusSum * radiusSum) {
+        if (checkCollision(*this, *m_player)) {
             // Only hurt player and boss stays invincible
             m_player->loseLife(3*60);
             m_dx = -m_dx;
@@ -278,14 +200,11 @@ void BossFish::update(float dt, bool& playerDied) {
     //updates the attack circles and checks collision with player
     for(auto it = m_Attacks_Circles.begin(); it != m_Attacks_Circles.end();) {
         auto& circle = *it;
+        circle->beginSweep();
         circle->update();
-        //Circle collsion with player
+        //Circle collsion with player, swept over the whole move so a shot can't skip past a small player
         if(m_player) {
-            float dx = circle->getX() - m_player->getX();
-            float dy = circle->getY() - m_player->getY();
-            float circleDistance = dx * dx + dy * dy;
-            float radiusSum = circle->getRadius() + m_player->getCollisionRadius();
-            if(circleDistance < radiusSum * radiusSum) {
+            if(sweepCollision(*circle, *m_player) >= 0.0f) {
                 m_player->loseLife(3*60);
                 it = m_Attacks_Circles.erase(it);
                 if (m_player->getLives() <= 0) {
@@ -296,24 +215,22 @@ void BossFish::update(float dt, bool& playerDied) {
             }
         }
         //removes circle that goes out of the bounds
-        if(circle->getX() < 0 || circle->getX() > ofGetWidth() || circle->getY() < 0 || circle->getY() > ofGetHeight()) {
+        if(circle->getX() < 0 || circle->getX() > m_maxX || circle->getY() < 0 || circle->getY() > m_maxY) {
             it = m_Attacks_Circles.erase(it);
         } else {
             ++it;
         }
     }
-    //removes boss
-    if (m_player && m_player->getScore() >= m_targetScore) {
-        m_isRemoved = true;
-    }
 }
 void BossFish::shootAttack() { //shoots a circle from the boss fish mouth located at the right-center of sprite boss fish
     if(!m_player) return;
     //Direction toward the player 
-    float centerX = m_x + 100;
-    float centerY = m_y + 100;
-    float dx = m_player->getX() - centerX;
-    float dy = m_player->getY() - centerY;
+    glm::vec2 center = getCollisionCenter();
+    glm::vec2 target = m_player->getCollisionCenter();
+    float centerX = center.x;
+    float centerY = center.y;
+    float dx = target.x - centerX;
+    float dy = target.y - centerY;
     float magnitude = sqrt(dx * dx + dy * dy);
     if(magnitude == 0) magnitude = 1;
     dx /= magnitude;
@@ -322,10 +239,11 @@ void BossFish::shootAttack() { //shoots a circle from the boss fish mouth locate
     float speed = 10.0f;
     dx *= speed;
     dy *= speed;
-    auto ball = std::make_shared<BossAttackPower>(centerX, centerY, dx, dy, 8.0f, ofColor::violet); 
+    auto ball = MakeTracked<BossAttackPower>(MemoryTag::PROJECTILES, centerX, centerY, dx, dy, 8.0f, ofColor::violet); 
     m_Attacks_Circles.push_back(ball);
+    PlaySfx(SfxId::BOSS_ATTACK, 0.6f, SfxPan(centerX, m_maxX));
 
-    ofLogNotice() << "Attack circle spawned at: (" << centerX << ", " << centerY << ")";
+    if (ShouldLog(OF_LOG_NOTICE)) ofLogNotice() << "Attack circle spawned at: (" << centerX << ", " << centerY << ")";
 }
 
 //PowerUp implementation 
@@ -364,11 +282,11 @@ void BossAttackPower::draw() const {
 
 // AquariumSpriteManager
 AquariumSpriteManager::AquariumSpriteManager(){
-    this->m_npc_fish = std::make_shared<GameSprite>("base-fish.png", 70,70);
-    this->m_big_fish = std::make_shared<GameSprite>("bigger-fish.png", 120, 120);
-    this->m_zaggy_fish = std::make_shared<GameSprite>("zaggy-fish.png", 80,80);
-    this->m_slowfish = std::make_shared<GameSprite>("slowfish.png", 100, 120);
-    this->m_boss_fish = std::make_shared<GameSprite>("bossFish.png", 200, 200); //Sprite Boss
+    this->m_npc_fish = std::make_shared<GameSprite>("base-fish.png", 70, 70, true);
+    this->m_big_fish = std::make_shared<GameSprite>("bigger-fish.png", 120, 120, true);
+    this->m_zaggy_fish = std::make_shared<GameSprite>("zaggy-fish.png", 80, 80, true);
+    this->m_slowfish = std::make_shared<GameSprite>("slowfish.png", 100, 120, true);
+    this->m_boss_fish = std::make_shared<GameSprite>("bossFish.png", 200, 200, true); //Sprite Boss
 }
 
 std::shared_ptr<GameSprite> AquariumSpriteManager::GetSprite(AquariumCreatureType t){
@@ -390,13 +308,37 @@ std::shared_ptr<GameSprite> AquariumSpriteManager::GetSprite(AquariumCreatureTyp
     }
 }
 
+const GameSprite* AquariumSpriteManager::GetPrototype(AquariumCreatureType t) const {
+    switch(t){
+        case AquariumCreatureType::BiggerFish: return this->m_big_fish.get();
+        case AquariumCreatureType::NPCreature: return this->m_npc_fish.get();
+        case AquariumCreatureType::ZaggyFish: return this->m_zaggy_fish.get();
+        case AquariumCreatureType::Slowfish: return this->m_slowfish.get();
+        case AquariumCreatureType::BossFish: return this->m_boss_fish.get();
+        default: return nullptr;
+    }
+}
+
 
 // Aquarium Implementation
-Aquarium::Aquarium(int width, int height, std::shared_ptr<AquariumSpriteManager> spriteManager)
-    : m_width(width), m_height(height) {
+Aquarium::Aquarium(int width, int height, std::shared_ptr<AquariumSpriteManager> spriteManager, unsigned int seed)
+    : m_width(width), m_height(height), m_rng(seed) {
         m_sprite_manager =  spriteManager;
+        m_playerField.Resize(width, height, kFlowCellSize);
+        // only one power-up at a time, a spawn that finds one in the tank waits for the next round
+        m_timers.SetHandler(static_cast<uint16_t>(GameTimer::POWER_UP_SPAWN), [this](TimerHandle, uint64_t) {
+            if (!this->hasPowerUp()) {
+                this->SpawnCreature(AquariumCreatureType::PowerUp);
+            }
+        });
+        m_timers.Schedule(kPowerUpSpawnTicks, static_cast<uint16_t>(GameTimer::POWER_UP_SPAWN), 0, kPowerUpSpawnTicks);
     }
 
+int Aquarium::RandomInt(int n) {
+    if (n <= 1) return 0;
+    return std::uniform_int_distribution<int>(0, n - 1)(m_rng);
+}
+
 
 
 void Aquarium::addCreature(std::shared_ptr<Creature> creature) {
@@ -409,50 +351,126 @@ void Aquarium::addAquariumLevel(std::shared_ptr<AquariumLevel> level){
     this->m_aquariumlevels.push_back(level);
 }
 
-void Aquarium::update(bool moveCreatures) {
-    bool hasPowerUp = false; // initial condition for to know if player has the powerup
-    for (auto& creature : m_creatures) {
-        // Only moves the creatures if the flag is true 
-        if(moveCreatures && !std::dynamic_pointer_cast<BossFish>(creature)) {
-            creature->move();
-        }
-
-        //spawn the power-up so it would exist one at a time 
-        if(std::dynamic_pointer_cast<PowerUpSpeed>(creature)) {
-            hasPowerUp = true;
+SimLod Aquarium::pickLod(SimLod current, int cells) {
+    switch (current) {
+        case SimLod::NEAR_PLAYER:
+            return cells >= 4 ? (cells >= 7 ? SimLod::FAR_AWAY : SimLod::MID_RANGE) : SimLod::NEAR_PLAYER;
+        case SimLod::MID_RANGE:
+            return cells <= 2 ? SimLod::NEAR_PLAYER : (cells >= 7 ? SimLod::FAR_AWAY : SimLod::MID_RANGE);
+        default:
+            return cells <= 2 ? SimLod::NEAR_PLAYER : (cells <= 5 ? SimLod::MID_RANGE : SimLod::FAR_AWAY);
+    }
+}
+
+void Aquarium::MoveCreatures() {
+    auto boss = m_boss.lock();
+    ++m_moveCounter;
+    m_lodCounts.fill(0);
+    for (int i = 0; i < (int)m_creatures.size(); ++i) {
+        Creature& creature = *m_creatures[i];
+        if (creature.getMotionKind() >= 0) {
+            NPCreature& fish = static_cast<NPCreature&>(creature);
+            SimLodState& lod = fish.lod();
+            ++m_lodCounts[static_cast<size_t>(lod.tier)];
+            ++lod.pendingSteps;
+            // fish of a tier are spread over the stride by their index, so a far tick doesn't step all of them.
+            // A fish that isn't due costs nothing more, its tier is only looked at again when it moves.
+            int stride = kLodStride[static_cast<size_t>(lod.tier)];
+            if (lod.pendingSteps < stride && (m_moveCounter + i) % stride != 0) continue;
+            // without a player everything runs at full rate. A fish moving to a finer tier steps what it owes
+            // in full right away.
+            int cells = m_playerField.HasTarget() ? m_playerField.GetDistance(fish.getX(), fish.getY()) : 0;
+            lod.tier = pickLod(lod.tier, cells);
+            if (lod.tier == SimLod::FAR_AWAY) {
+                FishKinds::Glide(fish, lod.pendingSteps);
+            } else {
+                FishKinds::Step(fish, &m_playerField, lod.pendingSteps); // statically dispatched, no virtual call
+            }
+            lod.pendingSteps = 0;
+        } else if (m_creatures[i] != boss) {
+            creature.move(); // power-ups and anything else that moves itself
         }
     }
-    static int frameCounter = 0;
-    frameCounter++;
+}
 
-    // Occasionally spawn a power-up in every few seconds (aprox every 4 seconds per frame) 
-    // and only if the power-Up doesn't exists yet
-    if (!hasPowerUp && frameCounter % 240 == 0) {
-        this->SpawnCreature(AquariumCreatureType::PowerUp);
+void Aquarium::update(bool moveCreatures) {
+    // Only moves the creatures if the flag is true 
+    if(moveCreatures) {
+        this->MoveCreatures();
     }
+    // power-ups drop on their own timer, see the constructor
     this->Repopulate();
 }
 
-void Aquarium::draw() const {
+void Aquarium::WriteSnapshot(AquariumSnapshot& out) const {
+    out.fish.clear();
+    out.unculled.clear();
+    out.circles.clear();
+    // with room to spare, so a power-up or a volley doesn't send the tick to the heap
+    if (out.fish.capacity() < m_creatures.size()) {
+        out.fish.reserve(2 * m_creatures.size() + kSnapshotSlack); // the population only creeps up to a new high
+        out.fishGrid.Reserve(int(out.fish.capacity()));
+    }
+    out.unculled.reserve(kSnapshotSlack);
+    out.circles.reserve(kMaxBossProjectiles + kSnapshotSlack);
+    auto boss = m_boss.lock();
     for (const auto& creature : m_creatures) {
-        creature->draw();
+        if (creature == boss) {
+            const GameSprite* sprite = m_sprite_manager ? m_sprite_manager->GetPrototype(AquariumCreatureType::BossFish) : nullptr;
+            out.unculled.push_back({sprite, boss->getX(), boss->getY(), boss->isFlipped()});
+            for (const auto& attack : boss->getAttackPower()) {
+                out.circles.push_back({attack->getX(), attack->getY(), attack->getRadius(), ofColor::violet});
+            }
+        } else if (creature->getMotionKind() >= 0) {
+            // fish that skipped moves for LOD are drawn where they would be
+            const NPCreature& fish = static_cast<const NPCreature&>(*creature);
+            glm::vec2 at(fish.getX(), fish.getY());
+            if (fish.lod().pendingSteps > 0) {
+                at = at + FishKinds::Velocity(fish) * float(fish.lod().pendingSteps);
+                at.x = std::clamp(at.x, 0.0f, float(m_width - 20));
+                at.y = std::clamp(at.y, 0.0f, float(m_height - 20));
+            }
+            const GameSprite* sprite = m_sprite_manager ? m_sprite_manager->GetPrototype(fish.GetType()) : nullptr;
+            out.fish.push_back({sprite, at.x, at.y, fish.isFlipped()});
+        } else if (creature == m_powerUp.lock()) {
+            out.circles.push_back({creature->getX(), creature->getY(), 10.0f, ofColor::red});
+        }
     }
+    // built here, once per tick on the sim side, instead of by every frame that draws a new tick
+    out.fishGrid.Build(m_width, m_height, AquariumSnapshot::kGridCellSize, int(out.fish.size()), [&out](int item) {
+        return glm::vec2(out.fish[item].x, out.fish[item].y);
+    });
+    out.lodCounts = m_lodCounts;
+    out.thinks = m_scheduler.GetStats();
+    out.thinkBudgetMillis = m_scheduler.GetBudgetMillis();
+    out.level = currentLevel;
 }
 
 
 void Aquarium::removeCreature(std::shared_ptr<Creature> creature) {
     auto it = std::find(m_creatures.begin(), m_creatures.end(), creature);
     if (it != m_creatures.end()) {
-        ofLogVerbose() << "removing creature " << endl;
+        if (IsVerboseLogging()) ofLogVerbose() << "removing creature " << endl;
         int selectLvl = this->currentLevel % this->m_aquariumlevels.size();
-        auto npcCreature = std::static_pointer_cast<NPCreature>(creature);
-        this->m_aquariumlevels.at(selectLvl)->ConsumePopulation(npcCreature->GetType(), npcCreature->getValue());
+        auto npcCreature = std::dynamic_pointer_cast<NPCreature>(creature);
+        if (npcCreature) { // power-ups are not part of the level population
+            this->m_aquariumlevels.at(selectLvl)->ConsumePopulation(npcCreature->GetType(), npcCreature->getValue());
+            m_scripts.Notify(); // the level score moved, the level script may be waiting on it
+        }
+        if (creature == m_boss.lock()) {
+            m_boss.reset();
+        }
+        if (creature == m_powerUp.lock()) {
+            m_powerUp.reset();
+        }
         m_creatures.erase(it);
     }
 }
 
 void Aquarium::clearCreatures() {
     m_creatures.clear();
+    m_boss.reset();
+    m_powerUp.reset();
 }
 
 std::shared_ptr<Creature> Aquarium::getCreatureAt(int index) {
@@ -465,22 +483,23 @@ std::shared_ptr<Creature> Aquarium::getCreatureAt(int index) {
 
 
 void Aquarium::SpawnCreature(AquariumCreatureType type, std::shared_ptr<PlayerCreature> player) {
-    int x = 20 + rand() % (this->getWidth() - 40);
-    int y = 20 + rand() % (this->getHeight() - 40);
-    int speed = 1 + rand() % 25; // Speed between 1 and 25
+    int x = 20 + this->RandomInt(this->getWidth() - 40);
+    int y = 20 + this->RandomInt(this->getHeight() - 40);
+    int speed = 1 + this->RandomInt(25); // Speed between 1 and 25
+    std::shared_ptr<NPCreature> fish;
 
     switch (type) {
         case AquariumCreatureType::NPCreature:
-            this->addCreature(std::make_shared<NPCreature>(x, y, speed, this->m_sprite_manager->GetSprite(AquariumCreatureType::NPCreature)));
+            fish = MakeTracked<BaseFish>(MemoryTag::CREATURES, x, y, speed, this->GetSprite(AquariumCreatureType::NPCreature));
             break;
         case AquariumCreatureType::BiggerFish:
-            this->addCreature(std::make_shared<BiggerFish>(x, y, speed, this->m_sprite_manager->GetSprite(AquariumCreatureType::BiggerFish)));
+            fish = MakeTracked<BiggerFish>(MemoryTag::CREATURES, x, y, speed, this->GetSprite(AquariumCreatureType::BiggerFish));
             break;
         case AquariumCreatureType::ZaggyFish:
-            this->addCreature(std::make_shared<ZaggyFish>(x, y, speed, this->m_sprite_manager->GetSprite(AquariumCreatureType::ZaggyFish)));
+            fish = MakeTracked<ZaggyFish>(MemoryTag::CREATURES, x, y, speed, this->GetSprite(AquariumCreatureType::ZaggyFish));
             break;
         case AquariumCreatureType::Slowfish:
-            this->addCreature(std::make_shared<Slowfish>(x, y, speed, this->m_sprite_manager->GetSprite(AquariumCreatureType::Slowfish)));
+            fish = MakeTracked<Slowfish>(MemoryTag::CREATURES, x, y, speed, this->GetSprite(AquariumCreatureType::Slowfish));
             break;
         case AquariumCreatureType::BossFish: {
             // Prevent duplicate bosses
@@ -489,53 +508,71 @@ void Aquarium::SpawnCreature(AquariumCreatureType type, std::shared_ptr<PlayerCr
             }
             int centerX = this->getWidth() / 2 - 100;
             int centerY = this->getHeight() / 2 - 100;
-            auto bossSprite = this->m_sprite_manager->GetSprite(AquariumCreatureType::BossFish);
-            auto boss = std::make_shared<BossFish>(centerX, centerY, 2, bossSprite);
+            auto bossSprite = this->GetSprite(AquariumCreatureType::BossFish);
+            auto boss = MakeTracked<BossFish>(MemoryTag::CREATURES, centerX, centerY, 2, bossSprite);
             boss->SetPlayer(player);
+            boss->setBounds(this->getWidth(), this->getHeight()); // boss does its own edge checks against the full tank
             m_creatures.push_back(std::static_pointer_cast<Creature>(boss));
-            break;   
+            m_boss = boss;
+            BossFish* thinker = boss.get();
+            m_scheduler.Register(boss, BossFish::kThinkSeconds, [thinker](float) { thinker->think(); });
+            m_scripts.Start(this->bossAttacks(boss));
+            return;
+        }
+        case AquariumCreatureType::PowerUp: {
+            auto powerUp = MakeTracked<PowerUpSpeed>(MemoryTag::CREATURES, x, y);
+            this->addCreature(powerUp);
+            m_powerUp = powerUp;
+            return;
         }
-        case AquariumCreatureType::PowerUp:
-            this->addCreature(std::make_shared<PowerUpSpeed>(x, y));
-            break;
         default:
             ofLogError() << "Unknown creature type to spawn!";
-            break;
+            return;
     }
 
+    // regular fish wander in one of the 8 directions, drawn from this tank's generator
+    fish->setHeading(this->RandomInt(3) - 1, this->RandomInt(3) - 1);
+    this->addCreature(fish);
+}
+
+std::shared_ptr<GameSprite> Aquarium::GetSprite(AquariumCreatureType type) {
+    if (!m_sprite_manager) return nullptr; // headless tank
+    return m_sprite_manager->GetSprite(type);
 }
 
 
+std::shared_ptr<AquariumLevel> Aquarium::getCurrentLevel() const {
+    if (m_aquariumlevels.empty()) return nullptr;
+    return m_aquariumlevels.at(std::min<size_t>(this->currentLevel, m_aquariumlevels.size() - 1));
+}
+
+void Aquarium::NextLevel() {
+    this->getCurrentLevel()->levelReset();
+    if (this->currentLevel < (int)this->m_aquariumlevels.size() - 1) {
+        this->currentLevel += 1;
+    }
+    if (ShouldLog(OF_LOG_NOTICE)) ofLogNotice() << "new level reached : " << this->currentLevel << std::endl;
+    this->clearCreatures();
+}
+
 // repopulation will be called from the levl class
 // it will compose into aquarium so eating eats frm the pool of NPCs in the lvl class
-// once lvl criteria met, we move to new lvl through inner signal asking for new lvl
-// which will mean incrementing the buffer and pointing to a new lvl index
+// moving on to the next level is up to the level script (see AquariumGameScene::runLevels)
 void Aquarium::Repopulate() {
-    ofLogVerbose("entering phase repopulation");
-    // lets make the levels circular
-    int selectedLevelIdx = this->currentLevel;
-    if(selectedLevelIdx >=this->m_aquariumlevels.size()) {
-        selectedLevelIdx = this->m_aquariumlevels.size() - 1;
-    }
-    ofLogVerbose() << "the current index: " << selectedLevelIdx << endl;
-    std::shared_ptr<AquariumLevel> level = this->m_aquariumlevels.at(selectedLevelIdx);
+    if (IsVerboseLogging()) ofLogVerbose() << "entering phase repopulation";
+    std::shared_ptr<AquariumLevel> level = this->getCurrentLevel();
 
-
-    if(level->isCompleted()){
-        level->levelReset();
-        if(this->currentLevel < (int)this->m_aquariumlevels.size() - 1) {
-            this->currentLevel += 1;
-        } // Suppose to spawn boss level
-        selectedLevelIdx = this->currentLevel % this->m_aquariumlevels.size();
-        ofLogNotice()<<"new level reached : " << selectedLevelIdx << std::endl;
-        level = this->m_aquariumlevels.at(selectedLevelIdx);
-        this->clearCreatures();
+    // the load governor and the hard cap shrink the level, its score target stays the same
+    float loadScale = this->GetLoadScale();
+    int levelPopulation = level->getTotalPopulation();
+    if (m_maxPopulation > 0 && levelPopulation > m_maxPopulation) {
+        loadScale = std::min(loadScale, float(m_maxPopulation) / levelPopulation);
     }
+    this->trimPopulation(*level, loadScale);
 
-    
     // now lets find how many to respawn if needed 
-    std::vector<AquariumCreatureType> toRespawn = level->Repopulate();
-    ofLogVerbose() << "amount to repopulate : " << toRespawn.size() << endl;
+    ArenaVector<AquariumCreatureType> toRespawn = level->Repopulate(m_frameArena, loadScale);
+    if (IsVerboseLogging()) ofLogVerbose() << "amount to repopulate : " << toRespawn.size() << endl;
     if(toRespawn.size() <= 0 ){return;} // there is nothing for me to do here
     for(AquariumCreatureType newCreatureType : toRespawn){
         this->SpawnCreature(newCreatureType);
@@ -543,18 +580,88 @@ void Aquarium::Repopulate() {
 }
 
 
+// The boss shoots at the player every cooldown for as long as it is in the tank, its projectiles capped by
+// the load scale
+Script Aquarium::bossAttacks(std::weak_ptr<BossFish> boss) {
+    while (true) {
+        uint64_t cooldown = 0;
+        if (auto attacker = boss.lock()) {
+            cooldown = attacker->getAttackCooldown();
+        }
+        co_await m_scripts.WaitSteps(cooldown);
+        auto attacker = boss.lock();
+        if (!attacker) {
+            co_return;
+        }
+        int maxProjectiles = std::max(1, int(kMaxBossProjectiles * this->GetLoadScale()));
+        if (int(attacker->getAttackPower().size()) < maxProjectiles) {
+            attacker->shootAttack();
+        }
+    }
+}
+
+void Aquarium::trimPopulation(AquariumLevel& level, float loadScale) {
+    int trimmed = 0;
+    for (size_t i = 0; i < m_creatures.size() && trimmed < kTrimPerRepopulate;) {
+        Creature& creature = *m_creatures[i];
+        if (creature.getMotionKind() >= 0) {
+            const NPCreature& fish = static_cast<const NPCreature&>(creature);
+            bool watched = fish.getX() >= m_watchedRegion.getLeft() && fish.getX() <= m_watchedRegion.getRight()
+                        && fish.getY() >= m_watchedRegion.getTop() && fish.getY() <= m_watchedRegion.getBottom();
+            if (!watched && level.ReleasePopulation(fish.GetType(), loadScale)) {
+                m_creatures.erase(m_creatures.begin() + i);
+                ++trimmed;
+                continue;
+            }
+        }
+        ++i;
+    }
+}
+
+
 // Aquarium collision detection
 std::shared_ptr<GameEvent> DetectAquariumCollisions(std::shared_ptr<Aquarium> aquarium, std::shared_ptr<PlayerCreature> player) {
     if (!aquarium || !player) return nullptr;
-    
+
+    // swept over everything that moved since the last check, the earliest hit wins
+    std::shared_ptr<Creature> hit;
+    float hitTime = 2.0f;
     for (int i = 0; i < aquarium->getCreatureCount(); ++i) {
         std::shared_ptr<Creature> npc = aquarium->getCreatureAt(i);
-        if (npc && checkCollision(player, npc)) {
-            return std::make_shared<GameEvent>(GameEventType::COLLISION, player, npc);
+        if (!npc) continue;
+        // fish outside the near tier are cells away from the player, they can't touch it
+        bool nearPlayer = npc->getMotionKind() < 0 || static_cast<NPCreature&>(*npc).lod().tier == SimLod::NEAR_PLAYER;
+        if (nearPlayer) {
+            float t = sweepCollision(*player, *npc);
+            if (t >= 0.0f && t < hitTime) {
+                hit = npc;
+                hitTime = t;
+            }
         }
     }
-    return nullptr;
+    if (hit) {
+        // put both back where they touched, so a fast mover bounces off the near side instead of the far one
+        player->rewindSweep(hitTime);
+        hit->rewindSweep(hitTime);
+    }
+    for (int i = 0; i < aquarium->getCreatureCount(); ++i) {
+        aquarium->getCreatureAt(i)->beginSweep();
+    }
+    player->beginSweep();
+    if (!hit) return nullptr;
+    auto event = MakeInArena<GameEvent>(aquarium->GetFrameArena(), GameEventType::COLLISION, player, hit);
+    event->timeOfImpact = hitTime;
+    return event;
 };
+void AddDefaultAquariumLevels(std::shared_ptr<Aquarium> aquarium) {
+    aquarium->addAquariumLevel(MakeTracked<Level_0>(MemoryTag::LEVELS, 0, 10));
+    aquarium->addAquariumLevel(MakeTracked<Level_1>(MemoryTag::LEVELS, 1, 15));
+    aquarium->addAquariumLevel(MakeTracked<Level_2>(MemoryTag::LEVELS, 2, 20));
+    aquarium->addAquariumLevel(MakeTracked<Level_3>(MemoryTag::LEVELS, 3, 25)); // this level ends when the player reaches 25 points
+    aquarium->addAquariumLevel(MakeTracked<Level_4>(MemoryTag::LEVELS, 4, 30)); // this level ends when the player reaches 30 points
+    aquarium->addAquariumLevel(MakeTracked<Level_Boss>(MemoryTag::LEVELS, 5, 40)); // this level ends when the player reaches 40 points
+}
+
 // functin so the npc as a minor reverse direction when collide
 void NPCreature::reverseDirection() {
     m_dx = -m_dx;
@@ -564,23 +671,86 @@ void NPCreature::reverseDirection() {
 //  Imlementation of the AquariumScene
 
 void AquariumGameScene::Update(){
+    // transient data lives in the tank's frame arena, so a tick that still hits the heap is worth counting.
+    // Spawned creatures and projectiles are tracked allocations and don't count.
+    uint64_t heapBefore = MemoryTracker::GetThreadUntrackedHeapAllocations();
+    this->Step(kFixedTickSeconds); // the app (or its sim thread) calls us once per fixed tick
+    if (MemoryTracker::GetThreadUntrackedHeapAllocations() != heapBefore) {
+        ++this->m_heapTicks;
+    }
+    this->PublishSnapshot();
+}
+
+void AquariumGameScene::PublishSnapshot(){
+    AquariumSnapshot& out = this->m_snapshots.Back();
+    this->m_aquarium->WriteSnapshot(out);
+    out.player = {this->m_player->getSprite(), this->m_player->getX(), this->m_player->getY(), this->m_player->isFlipped()};
+    out.playerHurt = this->m_player->isDamageDebounce();
+    out.score = this->m_player->getScore();
+    out.power = this->m_player->getPower();
+    out.lives = this->m_player->getLives();
+    auto boss = this->m_aquarium->getBoss();
+    out.bossHealth = boss ? boss->getHealth() : HudWidget::kHidden;
+    out.tick = ++this->m_tick;
+    out.heapTicks = this->m_heapTicks;
+    out.arenaPeakBytes = this->m_aquarium->GetFrameArena().GetPeakBytes();
+    this->m_snapshots.Publish();
+}
+
+void AquariumGameScene::ApplyInput(const InputFrame& input){
+    // only key changes steer, so a collision bounce keeps going until the player presses something else
+    if(!input.changed){return;}
+    float dx = float(input.IsHeld(InputKey::RIGHT)) - float(input.IsHeld(InputKey::LEFT));
+    float dy = float(input.IsHeld(InputKey::DOWN)) - float(input.IsHeld(InputKey::UP));
+    this->m_player->setDirection(dx, dy);
+    if(dx != 0){
+        this->m_player->setFlipped(dx < 0);
+    }
+}
+
+void AquariumGameScene::emitParticles(ParticleMaterial material, float x, float y, int count, float speed, float life){
+    if(this->m_particles){
+        this->m_bursts.Push({material, x, y, count, speed, life}); // emitted by the renderer, see Draw
+    }
+}
+
+void AquariumGameScene::Step(float dt){
     std::shared_ptr<GameEvent> event;
 
+    this->m_aquarium->BeginTick(); // before anything looks at the debounce, like the old per-tick countdowns
     this->m_player->update();
+    // where the renderer's camera will be for this tick, grown by a sprite on every side for bodies that reach
+    // into it and for fish drawn ahead of their LOD position
+    ofRectangle viewport = this->m_camera.GetViewportFor(this->m_player->getX(), this->m_player->getY());
+    this->m_aquarium->SetWatchedRegion(ofRectangle(viewport.x - kMaxSpriteExtent, viewport.y - kMaxSpriteExtent,
+                                                   viewport.width + 2 * kMaxSpriteExtent, viewport.height + 2 * kMaxSpriteExtent));
+    if(this->m_particles){
+        // a trail of bubbles while the player swims
+        this->m_bubbleClock += dt;
+        if(this->m_bubbleClock >= 0.15f && (this->m_player->isXDirectionActive() || this->m_player->isYDirectionActive())){
+            this->m_bubbleClock = 0.0f;
+            this->emitParticles(ParticleMaterial::BUBBLE, this->m_player->getX(), this->m_player->getY(), 2, 20.0f, 1.5f);
+        }
+    }
+
+    // creature decisions run on their own rate within the AI budget, on the tick's clock
+    m_aquarium->RunThinks(dt);
 
     if (this->updateControl.tick()) {
         event = DetectAquariumCollisions(this->m_aquarium, this->m_player);
         if (event != nullptr && event->isCollisionEvent()) {
-            ofLogVerbose() << "Collision detected between player and NPC!" << std::endl;
+            if (IsVerboseLogging()) ofLogVerbose() << "Collision detected between player and NPC!" << std::endl;
             // Handle PowerUp collision
             auto powerUp = std::dynamic_pointer_cast<PowerUpSpeed>(event->creatureB);
             if (powerUp) {
-                ofLogNotice() << "Player collected a PowerUpSpeed! Temporary speed boost activated." << std::endl;
+                if (ShouldLog(OF_LOG_NOTICE)) ofLogNotice() << "Player collected a PowerUpSpeed! Temporary speed boost activated." << std::endl;
                 // Temporary speed boost
                 this->m_player->changeSpeed(this->m_player->getSpeed() + 2);
-                this->m_player->m_speedBoostTimer = 300; // the speed would last 5 seconds
+                this->m_player->startSpeedBoost(300); // the speed would last 5 seconds
                 // Permanent power boost that makes the player stronger
                 this->m_player->increasePower(1);
+                PlaySfx(SfxId::POWER_UP, 1.0f, SfxPan(powerUp->getX(), m_aquarium->getWidth()));
+                this->emitParticles(ParticleMaterial::SPARK, powerUp->getX(), powerUp->getY(), 120, 220.0f, 0.8f);
                 this->m_aquarium->removeCreature(event->creatureB);
                 return;
             }
@@ -593,19 +763,25 @@ void AquariumGameScene::Update(){
                 // Player also bounces away
                 this->m_player->setDirection(-this->m_player->getDx(), -this->m_player->getDy());
                 if(this->m_player->getPower() < event->creatureB->getValue()){
-                    ofLogNotice() << "Player is too weak to eat the creature!" << std::endl;
+                    if (ShouldLog(OF_LOG_NOTICE)) ofLogNotice() << "Player is too weak to eat the creature!" << std::endl;
+                    if(!this->m_player->isDamageDebounce()){
+                        this->emitParticles(ParticleMaterial::IMPACT, this->m_player->getX(), this->m_player->getY(), 80, 180.0f, 0.6f);
+                    }
                     this->m_player->loseLife(3*60); // 3 frames debounce, 3 seconds at 60fps
                     if(this->m_player->getLives() <= 0){
-                        this->m_lastEvent = std::make_shared<GameEvent>(GameEventType::GAME_OVER, this->m_player, nullptr);
+                        this->m_lastEvent = MakeTracked<GameEvent>(MemoryTag::EVENTS, GameEventType::GAME_OVER, this->m_player, nullptr);
+                        this->RequestTransition(GameSceneKind::GAME_OVER);
                         return;
                     }
                 }
                 else{
                     this->m_aquarium->removeCreature(event->creatureB);
                     this->m_player->addToScore(1, event->creatureB->getValue());
+                    PlaySfx(SfxId::EAT, 1.0f, SfxPan(event->creatureB->getX(), m_aquarium->getWidth()));
+                    this->emitParticles(ParticleMaterial::SPARK, event->creatureB->getX(), event->creatureB->getY(), 60, 150.0f, 0.5f);
                     if (this->m_player->getScore() % 25 == 0){
                         this->m_player->increasePower(1);
-                        ofLogNotice() << "Player power increased to " << this->m_player->getPower() << "!" << std::endl;
+                        if (ShouldLog(OF_LOG_NOTICE)) ofLogNotice() << "Player power increased to " << this->m_player->getPower() << "!" << std::endl;
                     }
                     
                 }
@@ -617,88 +793,164 @@ void AquariumGameScene::Update(){
             }
         }
 
-        // Spawning the boss reliably on the last level
-        int lastLevelIndex = m_aquarium->getAquariumLevels().size() - 1; // index of the last level
-        // Spawn boss only if we are exactly on the last level and boss hasn't been spawned yet
-        if (!m_isBossSpawned && m_aquarium->getCurrentLevelI() == lastLevelIndex) {
-            m_aquarium->SpawnCreature(AquariumCreatureType::BossFish, m_player);
-            m_isBossSpawned = true;
-        }
-
         //Updating all creatures including the new boss fish for its implementation 
         bool playerDiedByBoss = false;
-        for (int i = 0; i < m_aquarium->getCreatureCount(); ++i) {
-            auto creature = m_aquarium->getCreatureAt(i);
-            if (!creature) continue; // skip null entries
-            // Try casting to BossFish
-            auto boss = std::dynamic_pointer_cast<BossFish>(creature);
-            if (boss) {
-                // Ensure the boss has a player pointer
-                if (!boss->GetPlayer() && this->m_player) {
-                    boss->SetPlayer(this->m_player);
-                }
-                // Use delta time
-                float dt = ofGetLastFrameTime();
-                if (dt <= 0) dt = 1.0f / 60.0f; // fallback to 60 FPS
-                // Update the boss (movement + attacks)
-                bool playerDied = false;
-                boss->update(dt, playerDied);
-                if (playerDied) {
-                    playerDiedByBoss = true;
-                }
+        auto boss = m_aquarium->getBoss();
+        if (boss) {
+            // Ensure the boss has a player pointer
+            if (!boss->GetPlayer() && this->m_player) {
+                boss->SetPlayer(this->m_player);
             }
-            else {
-                // Regular NPCs move normally
-                creature->move();
+            // Update the boss (movement + attacks)
+            int livesBefore = this->m_player->getLives();
+            boss->update(playerDiedByBoss);
+            if (this->m_player->getLives() < livesBefore) { // rammed or hit by a projectile
+                this->emitParticles(ParticleMaterial::IMPACT, this->m_player->getX(), this->m_player->getY(), 80, 180.0f, 0.6f);
             }
         }
+        // Regular NPCs move normally, predators and prey steer off the player's position
+        m_aquarium->SetPlayerPosition(this->m_player->getX(), this->m_player->getY());
+        m_aquarium->MoveCreatures();
         // If player died due to boss or boss attack, trigger game over
         if (playerDiedByBoss) {
-            this->m_lastEvent = std::make_shared<GameEvent>(GameEventType::GAME_OVER, this->m_player, nullptr);
+            this->m_lastEvent = MakeTracked<GameEvent>(MemoryTag::EVENTS, GameEventType::GAME_OVER, this->m_player, nullptr);
+            this->RequestTransition(GameSceneKind::GAME_OVER);
             return;
         }
-        //removes the boss when level is completed
-        for(int i = m_aquarium->getCreatureCount() - 1; i >= 0; --i) {
-            auto creature = m_aquarium->getCreatureAt(i);
-            auto boss = std::dynamic_pointer_cast<BossFish>(creature);
-            if (boss && boss->IsRemoved()) { // boss is dead
-                ofLogNotice() << "Removing dead boss from aquarium";
-                m_aquarium->removeCreature(std::static_pointer_cast<Creature>(boss));
-                m_isBossSpawned = false;
-            }
-        }
         this->m_aquarium->update(false);
     }
 
 }
 
-void AquariumGameScene::Draw() {
+// The level sequence. Each level lasts until its fish are eaten up to its target score, the last one brings
+// the boss, who leaves when that level is done, and then repeats.
+Script AquariumGameScene::runLevels() {
+    ScriptRunner& sim = m_aquarium->GetScripts();
+    while (true) {
+        std::shared_ptr<AquariumLevel> level = m_aquarium->getCurrentLevel();
+        if (!level) {
+            co_return;
+        }
+        bool bossLevel = m_aquarium->getCurrentLevelI() == int(m_aquarium->getAquariumLevels().size()) - 1;
+        if (bossLevel) {
+            m_aquarium->SpawnCreature(AquariumCreatureType::BossFish, m_player);
+        }
+        auto levelDone = [level]() { return level->isCompleted(); };
+        co_await sim.WaitUntil(levelDone);
+        if (auto boss = m_aquarium->getBoss()) {
+            if (ShouldLog(OF_LOG_NOTICE)) ofLogNotice() << "Removing dead boss from aquarium";
+            m_aquarium->removeCreature(std::static_pointer_cast<Creature>(boss));
+        }
+        m_aquarium->NextLevel();
+    }
+}
+
+void AquariumGameScene::Preload() {
+    // paint the HUD once so the first game frame doesn't pay for the FBO allocations
+    this->BeginDraw();
+    m_hud.Preload();
+}
+
+void AquariumGameScene::DrawStatic() {
     //current level background 
     if(!m_aquarium->getAquariumLevels().empty()) {
-        int i = m_aquarium->getCurrentLevelI() % m_aquarium->getAquariumLevels().size();
+        int i = this->GetView().level % m_aquarium->getAquariumLevels().size();
         auto currentLevel = m_aquarium->getAquariumLevels()[i];
 
         if(currentLevel && currentLevel->getBackGSprite()) {
             currentLevel->getBackGSprite()->draw(0, 0);
         }
     }
-    this->m_player->draw();
-    this->m_aquarium->draw();
+}
+
+void AquariumGameScene::Draw() {
+    // only the published snapshot is drawn, the live creatures may be mid-tick on the sim thread
+    const AquariumSnapshot& view = this->GetView();
+    if (this->m_particles) {
+        ParticleBurst burst;
+        while (this->m_bursts.Pop(burst)) {
+            this->m_particles->Emit(burst.material, burst.x, burst.y, burst.count, burst.speed, burst.life);
+        }
+        this->m_particles->Update(ofGetLastFrameTime());
+    }
+    this->drawSnapshot(view);
     this->paintAquariumHUD();
+}
+
+void AquariumGameScene::drawSnapshot(const AquariumSnapshot& view) {
+    // the world can be bigger than the window, keep the player in view and only draw what is on screen
+    this->m_camera.Follow(view.player.x, view.player.y);
+    this->m_camera.Begin();
+    if (view.player.sprite) {
+        ofSetColor(view.playerHurt ? ofColor::red : ofColor::white); // flash red in damage debounce
+        view.player.sprite->draw(view.player.x, view.player.y, view.player.flipped);
+        ofSetColor(ofColor::white);
+    }
+
+    // grow the query up/left so sprites whose position is off screen but whose body is visible still get in
+    ofRectangle viewport = this->m_camera.GetViewport();
+    ofRectangle region(viewport.x - kMaxSpriteExtent, viewport.y - kMaxSpriteExtent,
+                       viewport.width + kMaxSpriteExtent, viewport.height + kMaxSpriteExtent);
+    this->m_visible.clear();
+    view.fishGrid.Query(region, this->m_visible);
+    for (int item : this->m_visible) {
+        const AquariumSnapshot::Sprite& fish = view.fish[item];
+        if (fish.sprite) {
+            fish.sprite->draw(fish.x, fish.y, fish.flipped);
+        }
+    }
+    for (const AquariumSnapshot::Sprite& boss : view.unculled) {
+        if (boss.sprite) {
+            boss.sprite->draw(boss.x, boss.y, boss.flipped);
+        }
+    }
+    for (const AquariumSnapshot::Circle& circle : view.circles) {
+        ofSetColor(circle.color);
+        ofDrawCircle(circle.x, circle.y, circle.radius);
+    }
+    ofSetColor(ofColor::white);
 
+    if (this->m_particles) {
+        this->m_particles->Draw();
+    }
+    this->m_camera.End();
 }
 
 
-void AquariumGameScene::paintAquariumHUD(){
-    float panelWidth = ofGetWindowWidth() - 150;
-    ofDrawBitmapString("Score: " + std::to_string(this->m_player->getScore()), panelWidth, 20);
-    ofDrawBitmapString("Power: " + std::to_string(this->m_player->getPower()), panelWidth, 30);
-    ofDrawBitmapString("Lives: " + std::to_string(this->m_player->getLives()), panelWidth, 40);
-    for (int i = 0; i < this->m_player->getLives(); ++i) {
+void AquariumGameScene::buildAquariumHUD(){
+    // each element only repaints when its value changes, see HudWidget. Values come from the drawn snapshot.
+    m_hud.Add(ofRectangle(0, 8, 150, 14), [this](){ return this->GetView().score; }, [](int score){
+        ofDrawBitmapString("Score: " + std::to_string(score), 0, 12);
+    });
+    m_hud.Add(ofRectangle(0, 22, 150, 14), [this](){ return this->GetView().power; }, [](int power){
+        ofDrawBitmapString("Power: " + std::to_string(power), 0, 12);
+    });
+    m_hud.Add(ofRectangle(0, 36, 150, 28), [this](){ return this->GetView().lives; }, [](int lives){
+        ofDrawBitmapString("Lives: " + std::to_string(lives), 0, 12);
         ofSetColor(ofColor::red);
-        ofDrawCircle(panelWidth + i * 20, 50, 5);
-    }
-    ofSetColor(ofColor::white); // Reset color to white for other drawings
+        for (int i = 0; i < lives; ++i) {
+            ofDrawCircle(6 + i * 20, 20, 5);
+        }
+    });
+    m_hud.Add(ofRectangle(0, 64, 150, 14), [this](){ return this->GetView().level + 1; }, [](int level){
+        ofDrawBitmapString("Level: " + std::to_string(level), 0, 12);
+    });
+    // boss health bar, only while a boss is in the tank
+    m_hud.Add(ofRectangle(0, 78, 150, 24), [this](){ return this->GetView().bossHealth; }, [](int health){
+        ofDrawBitmapString("Boss", 0, 12);
+        ofSetColor(ofColor::darkGray);
+        ofDrawRectangle(0, 15, 120, 6);
+        ofSetColor(ofColor::violet);
+        ofDrawRectangle(0, 15, 120 * std::clamp(health, 0, BossFish::kMaxHealth) / float(BossFish::kMaxHealth), 6);
+    });
+}
+
+void AquariumGameScene::paintAquariumHUD(){
+    // laid out on the logical screen, top right, and scaled with it
+    const ViewProjection& projection = this->m_camera.GetProjection();
+    projection.Begin();
+    m_hud.Draw(projection.GetLogicalWidth() - 150, 0);
+    projection.End();
 }
 
 void AquariumLevel::populationReset(){
@@ -707,11 +959,15 @@ void AquariumLevel::populationReset(){
     }
 }
 
-std::vector<AquariumCreatureType> AquariumLevel::Repopulate() {
-    std::vector<AquariumCreatureType> toRepopulate;
+static int ScaledPopulation(int population, float loadScale) {
+    return population > 0 ? std::max(1, int(std::ceil(population * loadScale))) : 0;
+}
+
+ArenaVector<AquariumCreatureType> AquariumLevel::Repopulate(FrameArena& arena, float loadScale) {
+    ArenaVector<AquariumCreatureType> toRepopulate{ArenaAllocator<AquariumCreatureType>(arena)};
     for(std::shared_ptr<AquariumLevelPopulationNode> node : this->m_levelPopulation){
-        int delta = node->population - node->currentPopulation;
-        ofLogVerbose() << "to Repopulate :  " << delta << endl;
+        int delta = ScaledPopulation(node->population, loadScale) - node->currentPopulation;
+        if (IsVerboseLogging()) ofLogVerbose() << "to Repopulate :  " << delta << endl;
         if(delta >0){
             for(int i = 0; i<delta; i++){
                 toRepopulate.push_back(node->creatureType);
@@ -725,20 +981,38 @@ std::vector<AquariumCreatureType> AquariumLevel::Repopulate() {
 
 void AquariumLevel::ConsumePopulation(AquariumCreatureType creatureType, int power){
     for(std::shared_ptr<AquariumLevelPopulationNode> node: this->m_levelPopulation){
-        ofLogVerbose() << "consuming from this level creatures" << endl;
+        if (IsVerboseLogging()) ofLogVerbose() << "consuming from this level creatures" << endl;
         if(node->creatureType == creatureType){
-            ofLogVerbose() << "-cosuming from type: " << AquariumCreatureTypeToString(node->creatureType) <<" , currPop: " << node->currentPopulation << endl;
+            if (IsVerboseLogging()) ofLogVerbose() << "-cosuming from type: " << AquariumCreatureTypeToString(node->creatureType) <<" , currPop: " << node->currentPopulation << endl;
             if(node->currentPopulation == 0){
                 return;
             } 
             node->currentPopulation -= 1;
-            ofLogVerbose() << "+cosuming from type: " << AquariumCreatureTypeToString(node->creatureType) <<" , currPop: " << node->currentPopulation << endl;
+            if (IsVerboseLogging()) ofLogVerbose() << "+cosuming from type: " << AquariumCreatureTypeToString(node->creatureType) <<" , currPop: " << node->currentPopulation << endl;
             this->m_level_score += power;
             return;
         }
     }
 }
 
+bool AquariumLevel::ReleasePopulation(AquariumCreatureType creatureType, float loadScale){
+    for(std::shared_ptr<AquariumLevelPopulationNode> node: this->m_levelPopulation){
+        if(node->creatureType == creatureType && node->currentPopulation > ScaledPopulation(node->population, loadScale)){
+            node->currentPopulation -= 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+int AquariumLevel::getTotalPopulation() const {
+    int total = 0;
+    for(const auto& node: this->m_levelPopulation){
+        total += node->population;
+    }
+    return total;
+}
+
 bool AquariumLevel::isCompleted(){
     return this->m_level_score >= this->m_targetScore;
 }
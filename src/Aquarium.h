@@ -5,7 +5,19 @@
 #include <memory>
 #include <iostream>
 #include <algorithm>
+#include <random>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include "Core.h"
+#include "TimerWheel.h"
+#include "Script.h"
+#include "FrameArena.h"
+#include "InputSampler.h"
+#include "ThinkScheduler.h"
+#include "SfxMixer.h"
+#include "ParticleSystem.h"
+#include "SimThread.h"
 
 
 class BossAttackPower;
@@ -21,6 +33,14 @@ enum class AquariumCreatureType {
 
 string AquariumCreatureTypeToString(AquariumCreatureType t);
 
+// kinds of the tank's TimerWheel timers, each has one handler registered by whoever owns that timer
+enum class GameTimer : uint16_t {
+    DAMAGE_DEBOUNCE, // player, ends the invulnerability after a hit
+    SPEED_BOOST,     // player, ends the power-up's speed boost
+    POWER_UP_SPAWN,  // tank, repeating, drops a power-up when there is none
+    COUNT
+};
+
 class AquariumLevelPopulationNode{
     public:
         AquariumLevelPopulationNode() = default;
@@ -42,7 +62,12 @@ class AquariumLevel : public GameLevel {
         bool isCompleted() override;
         void populationReset();
         void levelReset(){m_level_score=0;this->populationReset();}
-        virtual std::vector<AquariumCreatureType> Repopulate();
+        // what is missing for each node, with every population scaled down by the load scale (at least 1 each),
+        // in the tick's arena
+        virtual ArenaVector<AquariumCreatureType> Repopulate(FrameArena& arena, float loadScale = 1.0f);
+        // forgets one creature of the type without scoring, when the node holds more than its scaled population
+        bool ReleasePopulation(AquariumCreatureType creatureType, float loadScale);
+        int getTotalPopulation() const;
 
         void setBackGSprite(std::shared_ptr<GameSprite> sprite) { m_background_sprite = sprite; }
         std::shared_ptr<GameSprite> getBackGSprite() const {return m_background_sprite; }
@@ -78,81 +103,287 @@ public:
     int getScore()const { return m_score; }
     int getLives() const { return m_lives; }
     int getPower() const { return m_power; }
-    int m_speedBoostTimer = 0; // variable for the timer 
+
+    // the debounce and the speed boost run on the tank's timers, the scene binds them
+    void bindTimers(TimerWheel* timers);
+    void startSpeedBoost(int ticks); // the caller raises the speed, this takes 2 back off when it runs out
+    bool isSpeedBoosted() const { return m_timers && m_timers->IsPending(m_speedBoostTimer); }
     
     void addToScore(int amount, int weight=1) { m_score += amount * weight; }
     void loseLife(int debounce);
     void increasePower(int value) { m_power += value; }
-    void reduceDamageDebounce();
-    // Returns true if the player is still in damage debounce frames
-    bool isDamageDebounce() const { return m_damage_debounce > 0;}
+    // Returns true if the player is still in damage debounce ticks
+    bool isDamageDebounce() const { return m_timers && m_timers->IsPending(m_damageTimer); }
 
 private:
+    void endSpeedBoost();
     int m_score = 0;
     int m_lives = 3;
     int m_power = 1; // mark current power lvl
-    int m_damage_debounce = 0; // frames to wait after eating
+    TimerWheel* m_timers = nullptr;
+    TimerHandle m_damageTimer; // ticks to wait after a hit
+    TimerHandle m_speedBoostTimer;
+};
+
+// Simulation level of detail, picked from the distance to the player whenever the fish is due to move. Far
+// fish move less often but with proportionally bigger steps, and are drawn extrapolated in between so they
+// don't stutter.
+enum class SimLod {
+    NEAR_PLAYER, // every move, collides with the player
+    MID_RANGE,   // every 2nd move, 2 full steps at once
+    FAR_AWAY,    // every 4th move, 4 steps in one straight glide without steering
+    COUNT
+};
+
+struct SimLodState {
+    SimLod tier = SimLod::NEAR_PLAYER;
+    int pendingSteps = 0; // moves owed since the fish last stepped
 };
 
 class NPCreature : public Creature {
 public:
     NPCreature(float x, float y, int speed, std::shared_ptr<GameSprite> sprite);
-    AquariumCreatureType GetType() {return this->m_creatureType;}
+    AquariumCreatureType GetType() const {return this->m_creatureType;}
     void move() override;
     void draw() const override;
+    void drawAt(float x, float y) const;
     void reverseDirection();
+    void setHeading(float dx, float dy); // normalized travel direction, picked by the owning aquarium
+    SimLodState& lod() { return m_lod; }
+    const SimLodState& lod() const { return m_lod; }
 protected:
     AquariumCreatureType m_creatureType;
+    // per-creature clock for the sin drifts, so tanks don't share ofGetElapsedTimef()
+    float m_driftTime = 0.0f;
+    static constexpr float kDriftTimeStep = 6.0f / 60.0f; // creatures move once every 6 frames
+    SimLodState m_lod;
 
+    template <typename Speed, typename Drift, typename Boundary, typename Steering>
+    friend struct FishMotion;
 };
 
-class BiggerFish : public NPCreature {
-public:
-    BiggerFish(float x, float y, int speed, std::shared_ptr<GameSprite> sprite);
-    void move() override;
-    void draw() const override;
+// Fish movement is composed from policies at compile time instead of overriding move() per fish.
+// Speed: per-axis multiplier on the fish speed, kept as a ratio so it stays a constant
+template <int XNum, int YNum, int Den>
+struct SpeedScale {
+    static constexpr float kX = float(XNum) / Den;
+    static constexpr float kY = float(YNum) / Den;
 };
 
-// Inheritance class for the new fish (ZaggyFish)
-class ZaggyFish : public NPCreature {
-public:
-    ZaggyFish(float x, float y, int speed, std::shared_ptr<GameSprite> sprite);
-    void move() override;
-    void draw() const override;
+// Drift: vertical offset added on every move. Sum is what `steps` moves add up to, the clock at `time` before
+// the first one.
+struct NoDrift {
+    static constexpr bool kEnabled = false;
+    static float Offset(float) { return 0.0f; }
+    static float Sum(float, float, int) { return 0.0f; }
+};
+
+template <int Frequency, int Amplitude>
+struct SineDrift {
+    static constexpr bool kEnabled = true;
+    static float Offset(float time) { return std::sin(time * Frequency) * Amplitude; }
+    static float Sum(float time, float step, int steps) {
+        // sum of sin(a + j*d) over j = 1..n in closed form
+        float d = step * Frequency;
+        return std::sin(steps * d / 2) * std::sin(time * Frequency + (steps + 1) * d / 2) / std::sin(d / 2) * Amplitude;
+    }
+};
+
+// Boundary: what happens at the tank walls. Fold is where a straight move from inside [0, limit] ends up,
+// and which way it is going, after any number of walls.
+struct BounceOffWalls {
+    static void Apply(NPCreature& fish) { fish.bounce(); }
+    static float Fold(float position, float limit, float& direction) {
+        if (limit <= 0.0f) return 0.0f;
+        float phase = std::fmod(position, 2 * limit);
+        if (phase < 0.0f) phase += 2 * limit;
+        if (phase <= limit) return phase;
+        direction = -direction; // unfolded the move is straight, it runs backwards in the mirrored half
+        return 2 * limit - phase;
+    }
+};
+
+// Steering: turns the fish along the aquarium's flow field toward the player. The field is null or has no
+// target when there is no player, the fish then keeps its heading.
+struct Wander {
+    static void Apply(NPCreature&, const FlowField*) {}
+};
+
+template <int RangeCells>
+struct Pursue {
+    static void Apply(NPCreature& fish, const FlowField* field) {
+        if (!field || field->GetDistance(fish.getX(), fish.getY()) > RangeCells) return;
+        glm::vec2 heading = field->GetDirection(fish.getX(), fish.getY());
+        if (heading.x != 0 || heading.y != 0) fish.setHeading(heading.x, heading.y);
+    }
+};
+
+template <int RangeCells>
+struct Flee {
+    static void Apply(NPCreature& fish, const FlowField* field) {
+        if (!field || field->GetDistance(fish.getX(), fish.getY()) > RangeCells) return;
+        glm::vec2 heading = field->GetDirection(fish.getX(), fish.getY());
+        if (heading.x != 0 || heading.y != 0) fish.setHeading(-heading.x, -heading.y);
+    }
+};
+
+template <typename Speed, typename Drift, typename Boundary, typename Steering>
+struct FishMotion {
+    // steps > 1 catches up on moves skipped for the mid tier. Each one is a full move with its own steering,
+    // drift and wall bounce, so the fish ends up where it would have at full rate.
+    static void Step(NPCreature& fish, const FlowField* field, int steps = 1) {
+        for (int step = 0; step < steps; ++step) {
+            Steering::Apply(fish, field);
+            if constexpr (Drift::kEnabled) {
+                fish.m_driftTime += NPCreature::kDriftTimeStep;
+            }
+            fish.m_x += fish.m_dx * (fish.m_speed * Speed::kX);
+            fish.m_y += fish.m_dy * (fish.m_speed * Speed::kY) + Drift::Offset(fish.m_driftTime);
+            fish.setFlipped(fish.m_dx < 0);
+            Boundary::Apply(fish);
+        }
+    }
+
+    // far from the player: `steps` moves at once with no steering, whose range never reaches the far tier. The
+    // moves are a straight line plus the summed drift, folded off the walls instead of bounced move by move.
+    static void Glide(NPCreature& fish, int steps) {
+        float drift = 0.0f;
+        if constexpr (Drift::kEnabled) {
+            drift = Drift::Sum(fish.m_driftTime, NPCreature::kDriftTimeStep, steps);
+            fish.m_driftTime += steps * NPCreature::kDriftTimeStep;
+        }
+        fish.m_x = Boundary::Fold(fish.m_x + steps * fish.m_dx * (fish.m_speed * Speed::kX), fish.m_maxX, fish.m_dx);
+        fish.m_y = Boundary::Fold(fish.m_y + steps * fish.m_dy * (fish.m_speed * Speed::kY) + drift, fish.m_maxY, fish.m_dy);
+        fish.setFlipped(fish.m_dx < 0);
+    }
+
+    // distance covered by one move, without the drift
+    static glm::vec2 Velocity(const NPCreature& fish) {
+        return glm::vec2(fish.m_dx * fish.m_speed * Speed::kX, fish.m_dy * fish.m_speed * Speed::kY);
+    }
 };
 
-// Inheritance class for the new fish (slowfish)
-class Slowfish : public NPCreature {
+// A fish kind is its motion plus its stats. kCollisionRadius is only used without a sprite (headless tanks),
+// otherwise collisions come from the sprite's alpha mask.
+struct BaseFishKind {
+    using Motion = FishMotion<SpeedScale<1, 1, 1>, NoDrift, BounceOffWalls, Flee<1>>; // prey, darts away when the player gets close
+    static constexpr AquariumCreatureType kType = AquariumCreatureType::NPCreature;
+    static constexpr float kCollisionRadius = 30;
+    static constexpr int kValue = 1;
+};
+
+struct BiggerFishKind {
+    using Motion = FishMotion<SpeedScale<1, 1, 2>, NoDrift, BounceOffWalls, Pursue<3>>; // half speed, predator
+    static constexpr AquariumCreatureType kType = AquariumCreatureType::BiggerFish;
+    static constexpr float kCollisionRadius = 60; // Bigger fish have a larger collision radius
+    static constexpr int kValue = 5;
+};
+
+struct ZaggyFishKind {
+    using Motion = FishMotion<SpeedScale<1, 0, 1>, SineDrift<5, 10>, BounceOffWalls, Wander>; // zig-zags instead of moving vertically
+    static constexpr AquariumCreatureType kType = AquariumCreatureType::ZaggyFish;
+    static constexpr float kCollisionRadius = 40;
+    static constexpr int kValue = 4;
+};
+
+struct SlowfishKind {
+    using Motion = FishMotion<SpeedScale<1, 1, 4>, SineDrift<2, 2>, BounceOffWalls, Wander>; // quarter speed, small vertical drift
+    static constexpr AquariumCreatureType kType = AquariumCreatureType::Slowfish;
+    static constexpr float kCollisionRadius = 50;
+    static constexpr int kValue = 6;
+};
+
+// Every kind the aquarium can step. Step() picks the kind's motion through a chain of compares the
+// compiler inlines, no virtual call per fish.
+template <typename... Kinds>
+struct FishKindList {
+    template <typename Kind>
+    static constexpr int IndexOf() {
+        int index = 0;
+        int found = -1;
+        ((std::is_same_v<Kind, Kinds> ? (found = index, ++index) : ++index), ...);
+        return found;
+    }
+
+    static void Step(NPCreature& fish, const FlowField* field = nullptr, int steps = 1) {
+        StepKind(fish, field, steps, std::index_sequence_for<Kinds...>{});
+    }
+
+    static void Glide(NPCreature& fish, int steps) {
+        GlideKind(fish, steps, std::index_sequence_for<Kinds...>{});
+    }
+
+    static glm::vec2 Velocity(const NPCreature& fish) {
+        return VelocityKind(fish, std::index_sequence_for<Kinds...>{});
+    }
+
+private:
+    template <size_t... I>
+    static void StepKind(NPCreature& fish, const FlowField* field, int steps, std::index_sequence<I...>) {
+        int kind = fish.getMotionKind();
+        (void)((kind == int(I) && (std::tuple_element_t<I, std::tuple<Kinds...>>::Motion::Step(fish, field, steps), true)) || ...);
+    }
+
+    template <size_t... I>
+    static void GlideKind(NPCreature& fish, int steps, std::index_sequence<I...>) {
+        int kind = fish.getMotionKind();
+        (void)((kind == int(I) && (std::tuple_element_t<I, std::tuple<Kinds...>>::Motion::Glide(fish, steps), true)) || ...);
+    }
+
+    template <size_t... I>
+    static glm::vec2 VelocityKind(const NPCreature& fish, std::index_sequence<I...>) {
+        int kind = fish.getMotionKind();
+        glm::vec2 velocity(0.0f, 0.0f);
+        (void)((kind == int(I) && (velocity = std::tuple_element_t<I, std::tuple<Kinds...>>::Motion::Velocity(fish), true)) || ...);
+        return velocity;
+    }
+};
+
+// adding a fish is a new kind above plus an entry here
+using FishKinds = FishKindList<BaseFishKind, BiggerFishKind, ZaggyFishKind, SlowfishKind>;
+
+template <typename Kind>
+class PolicyFish : public NPCreature {
 public:
-    Slowfish(float x, float y, int speed, std::shared_ptr<GameSprite> sprite);
-    void move() override;
-    void draw() const override;
+    PolicyFish(float x, float y, int speed, std::shared_ptr<GameSprite> sprite)
+    : NPCreature(x, y, speed, std::move(sprite)) {
+        static_assert(FishKinds::IndexOf<Kind>() >= 0, "fish kind missing from FishKinds");
+        setCollisionRadius(Kind::kCollisionRadius);
+        m_value = Kind::kValue;
+        m_creatureType = Kind::kType;
+        m_motionKind = FishKinds::IndexOf<Kind>();
+    }
 };
 
+using BaseFish = PolicyFish<BaseFishKind>;
+using BiggerFish = PolicyFish<BiggerFishKind>;
+using ZaggyFish = PolicyFish<ZaggyFishKind>; //new fish
+using Slowfish = PolicyFish<SlowfishKind>; //new fish
+
 //Inheritance class for the boss fish
 class BossFish : public NPCreature {
     private: 
         int health;
-        float coolDownAttack; //cools down in between attacks in seconds
-        float lastAttackTime; // time that passes since last attack
+        uint64_t coolDownAttack; //ticks in between attacks, the boss's attack script fires shootAttack
         std::vector<std::shared_ptr<BossAttackPower>> m_Attacks_Circles;
         std::shared_ptr<PlayerCreature> m_player; // pass reference of player to store in boss fish class
-        bool m_isRemoved = false;
         bool m_hasGivenScore = false;
     public:
+        static constexpr int kMaxHealth = 4;
+        static constexpr float kThinkSeconds = 1.0f; // how often it reconsiders its direction
+        static constexpr float kTurnDistance = 300.0f;
         BossFish(float x, float y, int speed, std::shared_ptr<GameSprite> sprite);
 
         void SetPlayer(std::shared_ptr<PlayerCreature> player) { m_player = player; }
         std::shared_ptr<PlayerCreature> GetPlayer() const { return m_player; }
-        int m_targetScore = 40;  // default value for target score
+        uint64_t getAttackCooldown() const { return coolDownAttack; }
 
         void move() override;
         void draw() const override;
-        void update(float dt, bool& playerDied); //updates the attack timer and moves the boss
+        void update(bool& playerDied); //moves the boss and its attacks, when it shoots and leaves is scripted
         void shootAttack();
+        void think(); // turns toward the player, the tank's think scheduler runs it
 
-        bool IsRemoved() const { return m_isRemoved; }
-        void SetRemoved(bool removed) { m_isRemoved = removed; }
         int getHealth() const { return health; }
         std::vector<std::shared_ptr<BossAttackPower>>& getAttackPower() { return m_Attacks_Circles; }
 };
@@ -187,6 +418,8 @@ class AquariumSpriteManager {
         AquariumSpriteManager();
         ~AquariumSpriteManager() = default;
         std::shared_ptr<GameSprite>GetSprite(AquariumCreatureType t);
+        // the shared original, lives as long as the manager, so a render snapshot can point at it
+        const GameSprite* GetPrototype(AquariumCreatureType t) const;
     private:
         std::shared_ptr<GameSprite> m_npc_fish;
         std::shared_ptr<GameSprite> m_big_fish;
@@ -196,19 +429,79 @@ class AquariumSpriteManager {
 };
 
 
+// Everything the renderer needs to draw one tick of the game: positions, flips, sprites and HUD values.
+// The sim fills one per tick and hands it over through a TripleBuffer, so draw never touches live creatures.
+struct AquariumSnapshot {
+    struct Sprite {
+        const GameSprite* sprite; // a sprite manager prototype or the player's own, both outlive the scene
+        float x;
+        float y;
+        bool flipped;
+    };
+    struct Circle {
+        float x;
+        float y;
+        float radius;
+        ofColor color;
+    };
+    std::vector<Sprite> fish;     // culled against the viewport when drawn
+    SpatialGrid fishGrid;         // over fish, built with the snapshot so draw only queries it
+    static constexpr float kGridCellSize = 256.0f;
+    std::vector<Sprite> unculled; // bosses, drawn whole
+    std::vector<Circle> circles;  // power-ups and boss projectiles
+    Sprite player{nullptr, 0.0f, 0.0f, false};
+    bool playerHurt = false; // flashes red during the damage debounce
+
+    // HUD and overlay values
+    int score = 0;
+    int power = 0;
+    int lives = 0;
+    int level = 0;
+    int bossHealth = HudWidget::kHidden;
+    std::array<int, static_cast<size_t>(SimLod::COUNT)> lodCounts{};
+    ThinkStats thinks;
+    float thinkBudgetMillis = 0.0f;
+    uint64_t tick = 0;
+    uint64_t heapTicks = 0; // ticks so far that went to the general heap for something other than a new entity
+    size_t arenaPeakBytes = 0;
+};
+
 class Aquarium{
 public:
-    Aquarium(int width, int height, std::shared_ptr<AquariumSpriteManager> spriteManager);
+    // spriteManager may be null for headless tanks, creatures are then spawned without sprites
+    Aquarium(int width, int height, std::shared_ptr<AquariumSpriteManager> spriteManager, unsigned int seed = std::random_device{}());
     void addCreature(std::shared_ptr<Creature> creature);
     void addAquariumLevel(std::shared_ptr<AquariumLevel> level);
     void removeCreature(std::shared_ptr<Creature> creature);
     void clearCreatures();
     void update(bool moveCreatures = true);
-    void draw() const;
-    void setBounds(int w, int h) { m_width = w; m_height = h; }
-    void setMaxPopulation(int n) { m_maxPopulation = n; }
-    void Repopulate();
+    void MoveCreatures(); // every creature but the boss, which the scene updates itself, fish at their SimLod rate
+    int getLodCount(SimLod tier) const { return m_lodCounts[static_cast<size_t>(tier)]; }
+    void SetPlayerPosition(float x, float y) { m_playerField.SetTarget(x, y); } // predators and prey steer off this
+    void RunThinks(float dt) { m_scheduler.Run(dt); }
+    ThinkScheduler& GetScheduler() { return m_scheduler; }
+    // gameplay timers and cooldowns (see GameTimer), the scene advances them once per tick
+    TimerWheel& GetTimers() { return m_timers; }
+    // memory for what only lives during one tick (see FrameArena)
+    FrameArena& GetFrameArena() { return m_frameArena; }
+    // the scene calls this first thing in every tick: takes back the last tick's arena, then fires due timers
+    void BeginTick() { m_frameArena.Reset(); m_timers.Advance(); m_scripts.Advance(); } // scripts: levels, boss attacks
+    // level flow and boss attacks (see Script), resumed once per scene step next to the thinks
+    ScriptRunner& GetScripts() { return m_scripts; }
+    void WriteSnapshot(AquariumSnapshot& out) const; // the creature part, the scene adds the player and HUD
+    void setBounds(int w, int h) { m_width = w; m_height = h; m_playerField.Resize(w, h, kFlowCellSize); }
+    void setMaxPopulation(int n) { m_maxPopulation = n; } // hard cap on the level population, 0 for none
+    // scales level populations and boss projectiles (see LoadGovernor), may be set from the render thread
+    void SetLoadScale(float scale) { m_loadScale.store(std::clamp(scale, 0.0f, 1.0f), std::memory_order_relaxed); }
+    float GetLoadScale() const { return m_loadScale.load(std::memory_order_relaxed); }
+    void Repopulate(); // tops up the current level's population
+    // the part of the world the camera may show, in world units. Trimming leaves fish in it alone, empty (the
+    // default) means nobody is watching.
+    void SetWatchedRegion(const ofRectangle& region) { m_watchedRegion = region; }
+    void NextLevel(); // resets the current level and clears the tank for the next one, the last level repeats
     void SpawnCreature(AquariumCreatureType type, std::shared_ptr<PlayerCreature> player = nullptr);
+    void Seed(unsigned int seed) { m_rng.seed(seed); }
+    int RandomInt(int n); // uniform in [0, n), drawn from this tank's own generator
     
     std::shared_ptr<Creature> getCreatureAt(int index);
     int getCreatureCount() const { return m_creatures.size(); }
@@ -217,64 +510,147 @@ public:
 
     //getters for the current level and the aquarium levels
     int getCurrentLevelI() const { return currentLevel; }
+    std::shared_ptr<AquariumLevel> getCurrentLevel() const;
     const std::vector<std::shared_ptr<AquariumLevel>>& getAquariumLevels() const { return m_aquariumlevels; }
+    std::shared_ptr<BossFish> getBoss() const { return m_boss.lock(); } // null when no boss is in the tank
+    bool hasPowerUp() const { return !m_powerUp.expired(); }
 
 private:
+    std::shared_ptr<GameSprite> GetSprite(AquariumCreatureType type);
+    Script bossAttacks(std::weak_ptr<BossFish> boss);
     int m_maxPopulation = 0;
+    std::atomic<float> m_loadScale{1.0f};
+    // fish over the scaled population leave a few per repopulate, only from outside the watched region so
+    // nobody sees them go
+    void trimPopulation(AquariumLevel& level, float loadScale);
+    ofRectangle m_watchedRegion;
+    static constexpr int kTrimPerRepopulate = 4;
+    static constexpr int kMaxBossProjectiles = 12; // at load scale 1
+    static constexpr size_t kSnapshotSlack = 16;
     int m_width;
     int m_height;
     int currentLevel = 0;
+    static constexpr int kPowerUpSpawnTicks = 240 * 6; // 240 of the scene's tank updates, which run every 6th tick
+    std::mt19937 m_rng;
     std::vector<std::shared_ptr<Creature>> m_creatures;
     std::vector<std::shared_ptr<Creature>> m_next_creatures;
+    std::weak_ptr<BossFish> m_boss;
+    std::weak_ptr<Creature> m_powerUp; // only one power-up at a time
     std::vector<std::shared_ptr<AquariumLevel>> m_aquariumlevels;
     std::shared_ptr<AquariumSpriteManager> m_sprite_manager;
+
+    // one field toward the player for every fish, it only changes when the player crosses into another cell
+    static constexpr float kFlowCellSize = 128.0f;
+    FlowField m_playerField;
+    ThinkScheduler m_scheduler; // creature decisions, unlimited budget unless the app sets one
+    TimerWheel m_timers;
+    FrameArena m_frameArena;
+    ScriptRunner m_scripts; // declared after everything the scripts touch, so it is destroyed first
+
+    // simulation LOD, tiers are in flow field cells from the player and a fish has to move a cell past a
+    // boundary before it changes tier, so it doesn't flap at the edge
+    static SimLod pickLod(SimLod current, int cells);
+    static constexpr int kLodStride[] = {1, 2, 4}; // moves per step, per SimLod
+    int m_moveCounter = 0;
+    std::array<int, static_cast<size_t>(SimLod::COUNT)> m_lodCounts{};
 };
 
 
+// the event lives in the tank's frame arena, don't keep it past the tick
 std::shared_ptr<GameEvent> DetectAquariumCollisions(std::shared_ptr<Aquarium> aquarium, std::shared_ptr<PlayerCreature> player);
 
+// adds the level sequence the game ships with (Level_0 .. Level_Boss)
+void AddDefaultAquariumLevels(std::shared_ptr<Aquarium> aquarium);
+
 
 class AquariumGameScene : public GameScene {
     public:
-        AquariumGameScene(std::shared_ptr<PlayerCreature> player, std::shared_ptr<Aquarium> aquarium, string name)
-        : m_player(std::move(player)) , m_aquarium(std::move(aquarium)), m_name(name){}
+        AquariumGameScene(GameSceneKind kind, std::shared_ptr<PlayerCreature> player, std::shared_ptr<Aquarium> aquarium)
+        : GameScene(kind), m_player(std::move(player)) , m_aquarium(std::move(aquarium)){
+            m_camera.SetWorldSize(m_aquarium->getWidth(), m_aquarium->getHeight());
+            m_camera.SetViewportSize(m_aquarium->getWidth(), m_aquarium->getHeight()); // the app sets the real window size
+            m_player->bindTimers(&m_aquarium->GetTimers());
+            m_levelScript = m_aquarium->GetScripts().Start(this->runLevels());
+            this->buildAquariumHUD();
+            this->PublishSnapshot(); // so the first frame has something to draw
+            m_view = &m_snapshots.Read();
+        }
+        ~AquariumGameScene() { m_aquarium->GetScripts().Stop(m_levelScript); } // the tank may outlive us
         std::shared_ptr<GameEvent> GetLastEvent(){return m_lastEvent;}
         void SetLastEvent(std::shared_ptr<GameEvent> event){this->m_lastEvent = event;}
         std::shared_ptr<PlayerCreature> GetPlayer(){return this->m_player;}
         std::shared_ptr<Aquarium> GetAquarium(){return this->m_aquarium;}
-        string GetName()override {return this->m_name;}
-        void Update() override;
+        GameCamera& GetCamera(){return this->m_camera;}
+        // effects for eating and hits, headless tanks leave this unset
+        void SetParticles(std::shared_ptr<ParticleSystem> particles){this->m_particles = std::move(particles);}
+        std::shared_ptr<ParticleSystem> GetParticles(){return this->m_particles;}
+        void Update() override; // Step plus a new render snapshot, safe to run on the sim thread
+        void Step(float dt); // one simulation tick, no window or frame clock access
+        void PublishSnapshot(); // hands the current state to the renderer, Update does it after every Step
+        void ApplyInput(const InputFrame& input); // steers the player, call before the tick's Update
         void Draw() override;
-        bool m_isBossSpawned = false;
+        void DrawStatic() override;
+        void Preload() override;
+        int GetStaticKey() override { return this->GetView().level; } // backgrounds change per level
+        void BeginDraw() override { m_view = &m_snapshots.Read(); } // the newest published tick
+        const AquariumSnapshot& GetView() const { return *m_view; } // render thread, the tick picked by BeginDraw
     private:
+        void buildAquariumHUD();
         void paintAquariumHUD();
+        Script runLevels();
+        void drawSnapshot(const AquariumSnapshot& view);
+        void emitParticles(ParticleMaterial material, float x, float y, int count, float speed, float life);
         std::shared_ptr<PlayerCreature> m_player;
         std::shared_ptr<Aquarium> m_aquarium;
         std::shared_ptr<GameEvent> m_lastEvent;
-        string m_name;
         AwaitFrames updateControl{5};
+        ScriptId m_levelScript = 0;
+        GameCamera m_camera;
+        HudPanel m_hud;
+        std::shared_ptr<ParticleSystem> m_particles;
+        float m_bubbleClock = 0.0f;
+
+        // sim -> render handoff. Particles are visual only, the sim queues bursts and the renderer emits and
+        // updates them, a burst that doesn't fit the queue is dropped.
+        TripleBuffer<AquariumSnapshot> m_snapshots;
+        const AquariumSnapshot* m_view = nullptr; // what this frame draws, HUD and static layer included
+        uint64_t m_tick = 0;
+        uint64_t m_heapTicks = 0;
+        struct ParticleBurst {
+            ParticleMaterial material;
+            float x;
+            float y;
+            int count;
+            float speed;
+            float life;
+        };
+        SpscQueue<ParticleBurst, 256> m_bursts;
+
+        // render-side culling, a query on the snapshot's fish grid
+        static constexpr float kMaxSpriteExtent = 200.0f; // sprites draw right/down of their position, up to the boss size
+        std::vector<int> m_visible;
 };
 
 
 class Level_0 : public AquariumLevel  {
     public:
         Level_0(int levelNumber, int targetScore): AquariumLevel(levelNumber, targetScore){
-            this->m_levelPopulation.push_back(std::make_shared<AquariumLevelPopulationNode>(AquariumCreatureType::NPCreature, 10));
+            this->m_levelPopulation.push_back(MakeTracked<AquariumLevelPopulationNode>(MemoryTag::LEVELS, AquariumCreatureType::NPCreature, 10));
 
         };
 };
 class Level_1 : public AquariumLevel  {
     public:
         Level_1(int levelNumber, int targetScore): AquariumLevel(levelNumber, targetScore){
-            this->m_levelPopulation.push_back(std::make_shared<AquariumLevelPopulationNode>(AquariumCreatureType::NPCreature, 20));
+            this->m_levelPopulation.push_back(MakeTracked<AquariumLevelPopulationNode>(MemoryTag::LEVELS, AquariumCreatureType::NPCreature, 20));
 
         };
 };
 class Level_2 : public AquariumLevel  {
     public:
         Level_2(int levelNumber, int targetScore): AquariumLevel(levelNumber, targetScore){
-            this->m_levelPopulation.push_back(std::make_shared<AquariumLevelPopulationNode>(AquariumCreatureType::NPCreature, 30));
-            this->m_levelPopulation.push_back(std::make_shared<AquariumLevelPopulationNode>(AquariumCreatureType::BiggerFish, 5));
+            this->m_levelPopulation.push_back(MakeTracked<AquariumLevelPopulationNode>(MemoryTag::LEVELS, AquariumCreatureType::NPCreature, 30));
+            this->m_levelPopulation.push_back(MakeTracked<AquariumLevelPopulationNode>(MemoryTag::LEVELS, AquariumCreatureType::BiggerFish, 5));
 
         };
 };
@@ -283,19 +659,19 @@ class Level_2 : public AquariumLevel  {
 class Level_3 : public AquariumLevel {
     public:
         Level_3(int levelNumber, int targetScore): AquariumLevel(levelNumber, targetScore) {
-            this->m_levelPopulation.push_back(std::make_shared<AquariumLevelPopulationNode>(AquariumCreatureType::NPCreature, 35));
-            this->m_levelPopulation.push_back(std::make_shared<AquariumLevelPopulationNode>(AquariumCreatureType::BiggerFish, 5));
-            this->m_levelPopulation.push_back(std::make_shared<AquariumLevelPopulationNode>(AquariumCreatureType::ZaggyFish, 4));
+            this->m_levelPopulation.push_back(MakeTracked<AquariumLevelPopulationNode>(MemoryTag::LEVELS, AquariumCreatureType::NPCreature, 35));
+            this->m_levelPopulation.push_back(MakeTracked<AquariumLevelPopulationNode>(MemoryTag::LEVELS, AquariumCreatureType::BiggerFish, 5));
+            this->m_levelPopulation.push_back(MakeTracked<AquariumLevelPopulationNode>(MemoryTag::LEVELS, AquariumCreatureType::ZaggyFish, 4));
         };
 };
 
 class Level_4 : public AquariumLevel {
     public:
         Level_4(int levelNumber, int targetScore): AquariumLevel(levelNumber, targetScore) {
-            this->m_levelPopulation.push_back(std::make_shared<AquariumLevelPopulationNode>(AquariumCreatureType::NPCreature, 40));
-            this->m_levelPopulation.push_back(std::make_shared<AquariumLevelPopulationNode>(AquariumCreatureType::BiggerFish, 5));
-            this->m_levelPopulation.push_back(std::make_shared<AquariumLevelPopulationNode>(AquariumCreatureType::ZaggyFish, 4));
-            this->m_levelPopulation.push_back(std::make_shared<AquariumLevelPopulationNode>(AquariumCreatureType::Slowfish, 3));
+            this->m_levelPopulation.push_back(MakeTracked<AquariumLevelPopulationNode>(MemoryTag::LEVELS, AquariumCreatureType::NPCreature, 40));
+            this->m_levelPopulation.push_back(MakeTracked<AquariumLevelPopulationNode>(MemoryTag::LEVELS, AquariumCreatureType::BiggerFish, 5));
+            this->m_levelPopulation.push_back(MakeTracked<AquariumLevelPopulationNode>(MemoryTag::LEVELS, AquariumCreatureType::ZaggyFish, 4));
+            this->m_levelPopulation.push_back(MakeTracked<AquariumLevelPopulationNode>(MemoryTag::LEVELS, AquariumCreatureType::Slowfish, 3));
         };
 };
 
@@ -303,13 +679,9 @@ class Level_4 : public AquariumLevel {
 class Level_Boss : public AquariumLevel {
     public:
         Level_Boss(int levelNumber, int targetScore): AquariumLevel(levelNumber, targetScore) {
-            this->m_levelPopulation.push_back(std::make_shared<AquariumLevelPopulationNode>(AquariumCreatureType::NPCreature, 20));
-            this->m_levelPopulation.push_back(std::make_shared<AquariumLevelPopulationNode>(AquariumCreatureType::Slowfish, 2));
-            this->m_levelPopulation.push_back(std::make_shared<AquariumLevelPopulationNode>(AquariumCreatureType::BossFish, 1));
-
-            //sets the boss level background
-            auto bossBackG = std::make_shared<GameSprite>("backgroundBoss.png", ofGetWidth(), ofGetHeight());
-            this->setBackGSprite(bossBackG);
-
+            this->m_levelPopulation.push_back(MakeTracked<AquariumLevelPopulationNode>(MemoryTag::LEVELS, AquariumCreatureType::NPCreature, 20));
+            this->m_levelPopulation.push_back(MakeTracked<AquariumLevelPopulationNode>(MemoryTag::LEVELS, AquariumCreatureType::Slowfish, 2));
+            this->m_levelPopulation.push_back(MakeTracked<AquariumLevelPopulationNode>(MemoryTag::LEVELS, AquariumCreatureType::BossFish, 1));
+            // the boss background is set by the app through setBackGSprite, headless tanks go without it
         }
 };
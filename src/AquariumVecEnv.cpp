@@ -0,0 +1,208 @@
+#include "AquariumVecEnv.h"
+
+
+AquariumVecEnv::AquariumVecEnv(int numEnvs, unsigned int seed, int numThreads, int width, int height)
+: m_numEnvs(std::max(1, numEnvs)), m_seed(seed), m_width(width), m_height(height) {
+    m_tanks.resize(m_numEnvs);
+    m_observations.assign(size_t(m_numEnvs) * kObservationSize, 0.0f);
+    m_rewards.assign(m_numEnvs, 0.0f);
+    m_dones.assign(m_numEnvs, 0);
+
+    if (numThreads <= 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // the calling thread works too, so spawn one less
+    for (int i = 0; i < numThreads - 1; ++i) {
+        m_workers.emplace_back(&AquariumVecEnv::WorkerLoop, this);
+    }
+    this->Reset();
+}
+
+AquariumVecEnv::~AquariumVecEnv() {
+    {
+        std::lock_guard<std::mutex> lock(m_poolMutex);
+        m_shutdown = true;
+    }
+    m_wakeWorkers.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void AquariumVecEnv::Reset() {
+    this->RunAll(false);
+}
+
+void AquariumVecEnv::Step(const int* actions) {
+    m_jobActions = actions;
+    this->RunAll(true);
+    m_jobActions = nullptr;
+}
+
+void AquariumVecEnv::ResetTank(int index) {
+    Tank& tank = m_tanks[index];
+    // every (tank, episode) pair gets its own stream so runs replay exactly
+    unsigned int tankSeed = m_seed + 7919u * unsigned(index) + 104729u * tank.episode;
+    auto aquarium = std::make_shared<Aquarium>(m_width, m_height, nullptr, tankSeed);
+    AddDefaultAquariumLevels(aquarium);
+    aquarium->Repopulate();
+
+    auto player = MakeTracked<PlayerCreature>(MemoryTag::CREATURES, m_width / 2 - 50, m_height / 2 - 50, 5, nullptr);
+    player->setDirection(0, 0);
+    player->setBounds(m_width - 20, m_height - 20);
+
+    tank.scene = std::make_shared<AquariumGameScene>(GameSceneKind::AQUARIUM_GAME, player, aquarium);
+    tank.lastScore = player->getScore();
+    tank.lastLives = player->getLives();
+    ++tank.episode;
+
+    m_rewards[index] = 0.0f;
+    m_dones[index] = 0;
+    this->WriteObservation(index);
+}
+
+void AquariumVecEnv::StepTank(int index, int action) {
+    Tank& tank = m_tanks[index];
+    auto player = tank.scene->GetPlayer();
+
+    float dx = 0;
+    float dy = 0;
+    switch (static_cast<AquariumAction>(action)) {
+        case AquariumAction::UP: dy = -1; break;
+        case AquariumAction::DOWN: dy = 1; break;
+        case AquariumAction::LEFT: dx = -1; break;
+        case AquariumAction::RIGHT: dx = 1; break;
+        case AquariumAction::UP_LEFT: dx = -1; dy = -1; break;
+        case AquariumAction::UP_RIGHT: dx = 1; dy = -1; break;
+        case AquariumAction::DOWN_LEFT: dx = -1; dy = 1; break;
+        case AquariumAction::DOWN_RIGHT: dx = 1; dy = 1; break;
+        default: break;
+    }
+    player->setDirection(dx, dy);
+    if (dx != 0) {
+        player->setFlipped(dx < 0);
+    }
+
+    tank.scene->Step(kStepTime);
+
+    int score = player->getScore();
+    int lives = player->getLives();
+    m_rewards[index] = float(score - tank.lastScore) - kLifeLostPenalty * float(tank.lastLives - lives);
+    tank.lastScore = score;
+    tank.lastLives = lives;
+
+    auto lastEvent = tank.scene->GetLastEvent();
+    bool done = lives <= 0 || (lastEvent != nullptr && lastEvent->isGameOver());
+    if (done) {
+        float reward = m_rewards[index];
+        this->ResetTank(index);
+        m_rewards[index] = reward;
+        m_dones[index] = 1;
+        return;
+    }
+    m_dones[index] = 0;
+    this->WriteObservation(index);
+}
+
+void AquariumVecEnv::WriteObservation(int index) {
+    const Tank& tank = m_tanks[index];
+    auto player = tank.scene->GetPlayer();
+    auto aquarium = tank.scene->GetAquarium();
+    float* obs = m_observations.data() + size_t(index) * kObservationSize;
+
+    float px = player->getX();
+    float py = player->getY();
+    obs[0] = px / m_width;
+    obs[1] = py / m_height;
+    obs[2] = player->getDx();
+    obs[3] = player->getDy();
+    obs[4] = float(player->getPower());
+    obs[5] = float(player->getLives());
+    obs[6] = float(player->getScore());
+    obs[7] = float(aquarium->getCurrentLevelI());
+
+    // keep the k closest creatures with an insertion pass, k is tiny
+    float bestDistance[kNearestCreatures];
+    int bestIndex[kNearestCreatures];
+    int found = 0;
+    for (int i = 0; i < aquarium->getCreatureCount(); ++i) {
+        auto creature = aquarium->getCreatureAt(i);
+        float cx = creature->getX() - px;
+        float cy = creature->getY() - py;
+        float distance = cx * cx + cy * cy;
+        int slot = found < kNearestCreatures ? found++ : kNearestCreatures;
+        while (slot > 0 && bestDistance[slot - 1] > distance) {
+            if (slot < kNearestCreatures) {
+                bestDistance[slot] = bestDistance[slot - 1];
+                bestIndex[slot] = bestIndex[slot - 1];
+            }
+            --slot;
+        }
+        if (slot < kNearestCreatures) {
+            bestDistance[slot] = distance;
+            bestIndex[slot] = i;
+        }
+    }
+
+    float* slots = obs + 8;
+    for (int k = 0; k < kNearestCreatures; ++k, slots += 4) {
+        if (k >= found) {
+            slots[0] = slots[1] = slots[2] = slots[3] = 0.0f;
+            continue;
+        }
+        auto creature = aquarium->getCreatureAt(bestIndex[k]);
+        slots[0] = (creature->getX() - px) / m_width;
+        slots[1] = (creature->getY() - py) / m_height;
+        slots[2] = float(creature->getValue());
+        slots[3] = player->getPower() >= creature->getValue() ? 1.0f : 0.0f;
+    }
+}
+
+void AquariumVecEnv::RunChunks() {
+    int numChunks = (m_numEnvs + kChunkSize - 1) / kChunkSize;
+    for (int chunk = m_nextChunk.fetch_add(1); chunk < numChunks; chunk = m_nextChunk.fetch_add(1)) {
+        int begin = chunk * kChunkSize;
+        int end = std::min(m_numEnvs, begin + kChunkSize);
+        for (int i = begin; i < end; ++i) {
+            if (m_jobIsStep) {
+                this->StepTank(i, m_jobActions ? m_jobActions[i] : 0);
+            } else {
+                m_tanks[i].episode = 0;
+                this->ResetTank(i);
+            }
+        }
+    }
+}
+
+void AquariumVecEnv::RunAll(bool step) {
+    {
+        std::lock_guard<std::mutex> lock(m_poolMutex);
+        m_jobIsStep = step;
+        m_nextChunk = 0;
+        m_busyWorkers = int(m_workers.size());
+        ++m_generation;
+    }
+    m_wakeWorkers.notify_all();
+    this->RunChunks();
+
+    std::unique_lock<std::mutex> lock(m_poolMutex);
+    m_jobDone.wait(lock, [this] { return m_busyWorkers == 0; });
+}
+
+void AquariumVecEnv::WorkerLoop() {
+    uint64_t seenGeneration = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_poolMutex);
+            m_wakeWorkers.wait(lock, [&] { return m_shutdown || m_generation != seenGeneration; });
+            if (m_shutdown) return;
+            seenGeneration = m_generation;
+        }
+        this->RunChunks();
+        {
+            std::lock_guard<std::mutex> lock(m_poolMutex);
+            --m_busyWorkers;
+        }
+        m_jobDone.notify_one();
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Aquarium.h"
+
+// Actions a bot can take on a tank, one per env per step
+enum class AquariumAction {
+    NONE,
+    UP,
+    DOWN,
+    LEFT,
+    RIGHT,
+    UP_LEFT,
+    UP_RIGHT,
+    DOWN_LEFT,
+    DOWN_RIGHT,
+    COUNT
+};
+
+// Steps many independent headless aquariums at once for bots and automated playtesting.
+// Each tank is a full AquariumGameScene without sprites, seeded on its own so runs are reproducible.
+// Results land in contiguous buffers that are allocated once:
+//   observations: numEnvs * kObservationSize floats
+//   rewards:      numEnvs floats (score gained minus a penalty per life lost)
+//   dones:        numEnvs bytes, the tank is reset right after and the observation is the new episode
+// The tanks log their eats and lost lives as notices, only when the log level lets them through (see
+// ShouldLog). A host stepping thousands of them raises the level itself, as --bench-vec-env does.
+class AquariumVecEnv {
+    public:
+        static constexpr int kNearestCreatures = 4;
+        // player x, y, dx, dy, power, lives, score, level + (dx, dy, value, edible) per nearest creature
+        static constexpr int kObservationSize = 8 + kNearestCreatures * 4;
+        static constexpr float kStepTime = 1.0f / 60.0f;
+        static constexpr float kLifeLostPenalty = 5.0f;
+
+        // numThreads = 0 uses every hardware thread, the calling thread always helps
+        AquariumVecEnv(int numEnvs, unsigned int seed, int numThreads = 0, int width = 1024, int height = 768);
+        ~AquariumVecEnv();
+
+        void Reset();
+        void Step(const int* actions); // actions holds GetNumEnvs() values of AquariumAction
+
+        int GetNumEnvs() const { return m_numEnvs; }
+        const float* GetObservations() const { return m_observations.data(); }
+        const float* GetRewards() const { return m_rewards.data(); }
+        const uint8_t* GetDones() const { return m_dones.data(); }
+
+    private:
+        struct Tank {
+            std::shared_ptr<AquariumGameScene> scene;
+            int lastScore = 0;
+            int lastLives = 0;
+            unsigned int episode = 0;
+        };
+
+        void ResetTank(int index);
+        void StepTank(int index, int action);
+        void WriteObservation(int index);
+        void RunAll(bool step); // splits the tanks across the pool and waits for them
+        void RunChunks();
+        void WorkerLoop();
+
+        int m_numEnvs;
+        unsigned int m_seed;
+        int m_width;
+        int m_height;
+        std::vector<Tank> m_tanks;
+        std::vector<float> m_observations;
+        std::vector<float> m_rewards;
+        std::vector<uint8_t> m_dones;
+
+        // thread pool, workers wake up once per Step/Reset and grab chunks of tanks
+        static constexpr int kChunkSize = 16;
+        std::vector<std::thread> m_workers;
+        std::mutex m_poolMutex;
+        std::condition_variable m_wakeWorkers;
+        std::condition_variable m_jobDone;
+        uint64_t m_generation = 0;
+        int m_busyWorkers = 0;
+        bool m_shutdown = false;
+        bool m_jobIsStep = false;
+        const int* m_jobActions = nullptr;
+        std::atomic<int> m_nextChunk{0};
+};
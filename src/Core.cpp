@@ -36,7 +36,7 @@ void Creature::bounce() {
 
 
 void GameEvent::print() const {
-        
+        if (!IsVerboseLogging()) return; // called on every collision
         switch (type) {
             case GameEventType::NONE:
                 ofLogVerbose() << "No event." << std::endl;
@@ -66,18 +66,391 @@ void GameEvent::print() const {
 };
 
 // collision detection between two creatures
-bool checkCollision(std::shared_ptr<Creature> a, std::shared_ptr<Creature> b) {
-  if(!a || !b) {
+glm::vec2 Creature::getCollisionCenter() const {
+    const CollisionShape* shape = this->getCollisionShape();
+    if (!shape) {
+        return glm::vec2(m_x, m_y);
+    }
+    return glm::vec2(m_x, m_y) + shape->getCenter(this->isFlipped());
+}
+
+bool checkCollision(const Creature& a, const Creature& b, bool pixelAccurate) {
+    glm::vec2 delta = a.getCollisionCenter() - b.getCollisionCenter();
+    float distanceSqrt = delta.x * delta.x + delta.y * delta.y;
+    float radiusSum = a.getCollisionRadius() + b.getCollisionRadius();
+    if (distanceSqrt > radiusSum * radiusSum) {
         return false;
     }
+    const CollisionShape* shapeA = a.getCollisionShape();
+    const CollisionShape* shapeB = b.getCollisionShape();
+    if (!pixelAccurate || !shapeA || !shapeB) {
+        return true;
+    }
+    return CollisionShape::MasksOverlap(*shapeA, a.getX(), a.getY(), a.isFlipped(),
+                                        *shapeB, b.getX(), b.getY(), b.isFlipped());
+}
 
-    float dx = a->getX() - b->getX();
-    float dy = a->getY() - b->getY();
-    float distanceSqrt = dx * dx + dy * dy;
-    float radiusSum = a->getCollisionRadius() + b->getCollisionRadius();
-    return distanceSqrt <= radiusSum * radiusSum;
+bool checkCollision(std::shared_ptr<Creature> a, std::shared_ptr<Creature> b, bool pixelAccurate) {
+  if(!a || !b) {
+        return false;
+    }
+    return checkCollision(*a, *b, pixelAccurate);
 };
 
+float sweepCollision(const Creature& a, const Creature& b, bool pixelAccurate) {
+    // b relative to a: starts at s and moves by d, they touch while |s + t d| <= r
+    glm::vec2 offsetA = a.getCollisionCenter() - glm::vec2(a.getX(), a.getY());
+    glm::vec2 offsetB = b.getCollisionCenter() - glm::vec2(b.getX(), b.getY());
+    glm::vec2 moveA = glm::vec2(a.getX(), a.getY()) - a.getSweepStart();
+    glm::vec2 moveB = glm::vec2(b.getX(), b.getY()) - b.getSweepStart();
+    glm::vec2 s = (b.getSweepStart() + offsetB) - (a.getSweepStart() + offsetA);
+    glm::vec2 d = moveB - moveA;
+    float r = a.getCollisionRadius() + b.getCollisionRadius();
+
+    float qa = d.x * d.x + d.y * d.y;
+    float qb = 2.0f * (s.x * d.x + s.y * d.y);
+    float qc = s.x * s.x + s.y * s.y - r * r;
+    float enter = 0.0f;
+    float exit = 1.0f;
+    if (qa <= std::numeric_limits<float>::epsilon()) {
+        if (qc > 0.0f) return -1.0f; // not moving relative to each other and apart
+    } else {
+        float discriminant = qb * qb - 4.0f * qa * qc;
+        if (discriminant < 0.0f) return -1.0f;
+        float root = std::sqrt(discriminant);
+        float t0 = (-qb - root) / (2.0f * qa);
+        float t1 = (-qb + root) / (2.0f * qa);
+        if (t1 < 0.0f || t0 > 1.0f) return -1.0f;
+        enter = std::max(0.0f, t0);
+        exit = std::min(1.0f, t1);
+    }
+
+    const CollisionShape* shapeA = a.getCollisionShape();
+    const CollisionShape* shapeB = b.getCollisionShape();
+    if (!pixelAccurate || !shapeA || !shapeB) {
+        return enter;
+    }
+    // the circles overlap over [enter, exit], walk the masks along it a few pixels of relative motion at a time
+    float travel = std::sqrt(qa) * (exit - enter);
+    int samples = std::clamp(int(std::ceil(travel / 4.0f)), 1, 16);
+    for (int i = 0; i <= samples; ++i) {
+        float t = enter + (exit - enter) * i / samples;
+        glm::vec2 atA = a.getSweepStart() + moveA * t;
+        glm::vec2 atB = b.getSweepStart() + moveB * t;
+        if (CollisionShape::MasksOverlap(*shapeA, atA.x, atA.y, a.isFlipped(), *shapeB, atB.x, atB.y, b.isFlipped())) {
+            return t;
+        }
+    }
+    return -1.0f;
+}
+
+
+bool LoadTextureOnly(ofTexture& texture, const std::string& imagePath, int width, int height, ofPixels* pixelsOut) {
+    ofPixels pixels;
+    if (!ofLoadImage(pixels, imagePath)) {
+        return false;
+    }
+    pixels.resize(width, height, OF_INTERPOLATE_BICUBIC); // what ofImage::resize did
+    texture.loadData(pixels);
+    if (pixelsOut) {
+        *pixelsOut = std::move(pixels);
+    }
+    return true;
+}
+
+std::shared_ptr<const CollisionShape> CollisionShape::FromPixels(const ofPixels& pixels, unsigned char alphaThreshold) {
+    auto shape = std::make_shared<CollisionShape>();
+    int width = int(pixels.getWidth());
+    int height = int(pixels.getHeight());
+    size_t channels = pixels.getNumChannels();
+    shape->m_width = width;
+    shape->m_height = height;
+    shape->m_wordsPerRow = (width + 63) / 64;
+    shape->m_mask.assign(size_t(shape->m_wordsPerRow) * height, 0);
+    shape->m_mirrored.assign(shape->m_mask.size(), 0);
+
+    // images without alpha are solid
+    const unsigned char* data = pixels.getData();
+    int minX = width, minY = height, maxX = -1, maxY = -1;
+    for (int y = 0; y < height; ++y) {
+        uint64_t* row = shape->m_mask.data() + size_t(y) * shape->m_wordsPerRow;
+        uint64_t* mirrored = shape->m_mirrored.data() + size_t(y) * shape->m_wordsPerRow;
+        for (int x = 0; x < width; ++x) {
+            bool opaque = channels < 4 || !data || data[(size_t(y) * width + x) * channels + 3] >= alphaThreshold;
+            if (!opaque) continue;
+            row[x / 64] |= uint64_t(1) << (x % 64);
+            int mx = width - 1 - x;
+            mirrored[mx / 64] |= uint64_t(1) << (mx % 64);
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+        }
+    }
+    if (maxX < 0) {
+        return shape; // nothing opaque, isEmpty()
+    }
+    shape->m_bounds.set(minX, minY, maxX - minX + 1, maxY - minY + 1);
+    shape->m_center = glm::vec2((minX + maxX + 1) * 0.5f, (minY + maxY + 1) * 0.5f);
+
+    // circle around the box centre reaching the farthest opaque pixel corner
+    float farthest = 0.0f;
+    for (int y = minY; y <= maxY; ++y) {
+        const uint64_t* row = shape->row(y, false);
+        for (int x = minX; x <= maxX; ++x) {
+            if (!(row[x / 64] >> (x % 64) & 1)) continue;
+            float dx = std::max(std::abs(x - shape->m_center.x), std::abs(x + 1 - shape->m_center.x));
+            float dy = std::max(std::abs(y - shape->m_center.y), std::abs(y + 1 - shape->m_center.y));
+            farthest = std::max(farthest, dx * dx + dy * dy);
+        }
+    }
+    shape->m_radius = std::sqrt(farthest);
+    shape->m_memory.Set(MemoryTag::SPRITES, 2 * shape->m_mask.size() * sizeof(uint64_t));
+    return shape;
+}
+
+ofRectangle CollisionShape::getBounds(bool flipped) const {
+    if (!flipped) return m_bounds;
+    return ofRectangle(m_width - m_bounds.getRight(), m_bounds.y, m_bounds.width, m_bounds.height);
+}
+
+uint64_t CollisionShape::bitsAt(const uint64_t* row, int bit) const {
+    if (bit >= m_width || bit <= -64) return 0;
+    int word = bit >= 0 ? bit / 64 : -1;
+    int shift = bit - word * 64;
+    uint64_t low = word >= 0 ? row[word] >> shift : 0;
+    uint64_t high = (shift != 0 && word + 1 < m_wordsPerRow) ? row[word + 1] << (64 - shift) : 0;
+    return low | high;
+}
+
+bool CollisionShape::MasksOverlap(const CollisionShape& a, float ax, float ay, bool aFlipped,
+                                  const CollisionShape& b, float bx, float by, bool bFlipped) {
+    // b's draw position in a's pixels
+    int offsetX = int(std::lround(bx - ax));
+    int offsetY = int(std::lround(by - ay));
+
+    // only the rows and columns where both opaque boxes overlap can hit
+    ofRectangle boundsA = a.getBounds(aFlipped);
+    ofRectangle boundsB = b.getBounds(bFlipped);
+    int x0 = std::max(int(boundsA.getLeft()), int(boundsB.getLeft()) + offsetX);
+    int x1 = std::min(int(boundsA.getRight()), int(boundsB.getRight()) + offsetX);
+    int y0 = std::max(int(boundsA.getTop()), int(boundsB.getTop()) + offsetY);
+    int y1 = std::min(int(boundsA.getBottom()), int(boundsB.getBottom()) + offsetY);
+    if (x0 >= x1 || y0 >= y1) return false;
+
+    for (int y = y0; y < y1; ++y) {
+        const uint64_t* rowA = a.row(y, aFlipped);
+        const uint64_t* rowB = b.row(y - offsetY, bFlipped);
+        // a's words against the 64 pixels of b under each of them, b is clear outside its own width
+        for (int word = x0 / 64; word <= (x1 - 1) / 64; ++word) {
+            if (rowA[word] & b.bitsAt(rowB, word * 64 - offsetX)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+
+void SpatialGrid::Query(const ofRectangle& region, std::vector<int>& out) const {
+    if (m_cellsX == 0 || m_cellsY == 0) return;
+    int x0 = cellCoord(region.getLeft(), m_cellsX);
+    int x1 = cellCoord(region.getRight(), m_cellsX);
+    int y0 = cellCoord(region.getTop(), m_cellsY);
+    int y1 = cellCoord(region.getBottom(), m_cellsY);
+    for (int cy = y0; cy <= y1; ++cy) {
+        // cells of a row are contiguous, so one range covers the whole span
+        int begin = m_cellStart[cellIndex(x0, cy)];
+        int end = m_cellStart[cellIndex(x1, cy) + 1];
+        out.insert(out.end(), m_items.begin() + begin, m_items.begin() + end);
+    }
+}
+
+void FlowField::Resize(float worldWidth, float worldHeight, float cellSize) {
+    m_cellSize = cellSize;
+    m_cellsX = std::max(1, int(std::ceil(worldWidth / cellSize)));
+    m_cellsY = std::max(1, int(std::ceil(worldHeight / cellSize)));
+    m_distance.assign(size_t(m_cellsX) * m_cellsY, kUnreached);
+    m_direction.assign(m_distance.size(), glm::vec2(0.0f, 0.0f));
+    m_targetCell = -1;
+}
+
+int FlowField::cellOf(float x, float y) const {
+    int cx = std::clamp(int(x / m_cellSize), 0, m_cellsX - 1);
+    int cy = std::clamp(int(y / m_cellSize), 0, m_cellsY - 1);
+    return cy * m_cellsX + cx;
+}
+
+bool FlowField::SetTarget(float x, float y) {
+    if (m_distance.empty()) return false;
+    m_target = glm::vec2(x, y);
+    int cell = cellOf(x, y);
+    if (cell == m_targetCell) return false; // same cell, the field still holds
+    m_targetCell = cell;
+    this->rebuild();
+    return true;
+}
+
+void FlowField::rebuild() {
+    // breadth-first out from the target cell over the 8 neighbours
+    std::fill(m_distance.begin(), m_distance.end(), kUnreached);
+    m_frontier.clear();
+    m_frontier.push_back(m_targetCell);
+    m_distance[m_targetCell] = 0;
+    for (size_t head = 0; head < m_frontier.size(); ++head) {
+        int cell = m_frontier[head];
+        int cx = cell % m_cellsX;
+        int cy = cell / m_cellsX;
+        for (int ny = std::max(0, cy - 1); ny <= std::min(m_cellsY - 1, cy + 1); ++ny) {
+            for (int nx = std::max(0, cx - 1); nx <= std::min(m_cellsX - 1, cx + 1); ++nx) {
+                int neighbour = ny * m_cellsX + nx;
+                if (m_distance[neighbour] == kUnreached) {
+                    m_distance[neighbour] = m_distance[cell] + 1;
+                    m_frontier.push_back(neighbour);
+                }
+            }
+        }
+    }
+
+    // every cell points at its closest neighbour, ties go to the one nearest the target so the flow looks straight
+    int tx = m_targetCell % m_cellsX;
+    int ty = m_targetCell / m_cellsX;
+    for (int cell = 0; cell < (int)m_distance.size(); ++cell) {
+        int cx = cell % m_cellsX;
+        int cy = cell / m_cellsX;
+        int best = cell;
+        int bestStraight = std::numeric_limits<int>::max();
+        for (int ny = std::max(0, cy - 1); ny <= std::min(m_cellsY - 1, cy + 1); ++ny) {
+            for (int nx = std::max(0, cx - 1); nx <= std::min(m_cellsX - 1, cx + 1); ++nx) {
+                int neighbour = ny * m_cellsX + nx;
+                int straight = (nx - tx) * (nx - tx) + (ny - ty) * (ny - ty);
+                if (m_distance[neighbour] < m_distance[best] ||
+                    (m_distance[neighbour] == m_distance[best] && neighbour != cell && straight < bestStraight)) {
+                    best = neighbour;
+                    bestStraight = straight;
+                }
+            }
+        }
+        glm::vec2 step(best % m_cellsX - cx, best / m_cellsX - cy);
+        m_direction[cell] = best == cell ? glm::vec2(0.0f, 0.0f) : glm::normalize(step);
+    }
+}
+
+int FlowField::GetDistance(float x, float y) const {
+    if (m_targetCell < 0) return kUnreached;
+    return m_distance[cellOf(x, y)];
+}
+
+glm::vec2 FlowField::GetDirection(float x, float y) const {
+    if (m_targetCell < 0) return glm::vec2(0.0f, 0.0f);
+    int cell = cellOf(x, y);
+    if (cell == m_targetCell) {
+        // inside the target cell head straight at the point itself
+        glm::vec2 toTarget = m_target - glm::vec2(x, y);
+        float length = glm::length(toTarget);
+        return length > 0.0f ? toTarget / length : glm::vec2(0.0f, 0.0f);
+    }
+    return m_direction[cell];
+}
+
+void CachedLayer::Draw(int width, int height, int key, const std::function<void()>& paint) {
+    if (!m_fbo.isAllocated() || m_fbo.getWidth() != width || m_fbo.getHeight() != height) {
+        m_fbo.allocate(width, height, GL_RGBA);
+        m_dirty = true;
+    }
+    if (m_dirty || key != m_key) {
+        m_fbo.begin();
+        ofClear(0, 0, 0, 255);
+        paint();
+        m_fbo.end();
+        m_key = key;
+        m_dirty = false;
+    }
+    m_fbo.draw(0, 0);
+}
+
+void HudWidget::Draw(float originX, float originY) {
+    if (!this->Prepare()) return;
+    m_fbo.draw(originX + m_bounds.x, originY + m_bounds.y);
+}
+
+bool HudWidget::Prepare() {
+    int value = m_value();
+    if (value == kHidden) return false;
+    if (!m_fbo.isAllocated()) {
+        m_fbo.allocate(m_bounds.width, m_bounds.height, GL_RGBA);
+        m_dirty = true;
+    }
+    if (m_dirty || value != m_lastValue) {
+        m_fbo.begin();
+        ofClear(0, 0, 0, 0);
+        m_paint(value);
+        ofSetColor(ofColor::white);
+        m_fbo.end();
+        m_lastValue = value;
+        m_dirty = false;
+    }
+    return true;
+}
+
+void HudPanel::Draw(float originX, float originY) {
+    for (auto& widget : m_widgets) {
+        widget.Draw(originX, originY);
+    }
+}
+
+void HudPanel::Preload() {
+    for (auto& widget : m_widgets) {
+        widget.Prepare();
+    }
+}
+
+void HudPanel::Invalidate() {
+    for (auto& widget : m_widgets) {
+        widget.Invalidate();
+    }
+}
+
+void GameCamera::Follow(float x, float y) {
+    ofRectangle viewport = this->GetViewportFor(x, y);
+    m_x = viewport.x;
+    m_y = viewport.y;
+}
+
+ofRectangle GameCamera::GetViewportFor(float x, float y) const {
+    // center on the target, then clamp so we never show outside the world
+    float left = x - m_viewWidth / 2;
+    float top = y - m_viewHeight / 2;
+    left = m_worldWidth > m_viewWidth ? ofClamp(left, 0, m_worldWidth - m_viewWidth) : 0;
+    top = m_worldHeight > m_viewHeight ? ofClamp(top, 0, m_worldHeight - m_viewHeight) : 0;
+    return ofRectangle(left, top, m_viewWidth, m_viewHeight);
+}
+
+void GameCamera::Begin() const {
+    m_projection.Begin();
+    ofTranslate(-m_x, -m_y);
+}
+
+void GameCamera::End() const {
+    m_projection.End();
+}
+
+void ViewProjection::update() {
+    // the largest uniform scale that fits, the leftover is split evenly into bars
+    m_scale = std::min(m_windowWidth / m_logicalWidth, m_windowHeight / m_logicalHeight);
+    m_offsetX = (m_windowWidth - m_logicalWidth * m_scale) / 2;
+    m_offsetY = (m_windowHeight - m_logicalHeight * m_scale) / 2;
+}
+
+void ViewProjection::Begin() const {
+    ofPushMatrix();
+    ofTranslate(m_offsetX, m_offsetY);
+    ofScale(m_scale, m_scale);
+}
+
+void ViewProjection::End() const {
+    ofPopMatrix();
+}
 
 string GameSceneKindToString(GameSceneKind t){
     switch(t)
@@ -85,52 +458,54 @@ string GameSceneKindToString(GameSceneKind t){
         case GameSceneKind::GAME_INTRO: return "GAME_INTRO";
         case GameSceneKind::AQUARIUM_GAME: return "AQUARIUM_GAME";
         case GameSceneKind::GAME_OVER: return "GAME_OVER";
+        default: return "UNKNOWN_SCENE";
     };
 };
 
-std::shared_ptr<GameScene> GameSceneManager::GetScene(string name){
-    if(!this->HasScenes()){return nullptr;}
-    for(std::shared_ptr<GameScene> scene : this->m_scenes){
-        if(scene->GetName() == name){
-            return scene;
-        }
-    }
-    return nullptr;
+void GameSceneManager::PreloadScene(GameSceneKind kind){
+    size_t slot = static_cast<size_t>(kind);
+    if(this->m_scenes[slot] == nullptr || this->m_preloaded[slot]){return;} // nothing to warm or already warm
+    this->m_scenes[slot]->Preload();
+    this->m_preloaded[slot] = true;
 }
 
-void GameSceneManager::Transition(string name){
-    if(!this->HasScenes()){return;} // no need to do anything if nothing inside
-    std::shared_ptr<GameScene> newScene = this->GetScene(name);
+void GameSceneManager::Transition(GameSceneKind kind){
+    std::shared_ptr<GameScene> newScene = this->GetScene(kind);
     if(newScene == nullptr){return;} // i dont have the scene so time to leave
-    if(newScene->GetName() == this->m_active_scene->GetName()){return;} // another do nothing since active scene is already pulled
+    if(newScene == this->m_active_scene){return;} // another do nothing since active scene is already pulled
+    this->PreloadScene(kind);
+    if(this->m_active_scene != nullptr){
+        this->m_active_scene->OnExit();
+        ofLogNotice() << "Scene transition: " << GameSceneKindToString(this->m_active_kind) << " -> " << GameSceneKindToString(kind);
+    }
     this->m_active_scene = newScene; // now we keep it since this is a valid transition
-    return;
+    this->m_active_kind = kind;
+    this->m_active_scene->OnEnter();
 }
 
 void GameSceneManager::AddScene(std::shared_ptr<GameScene> newScene){
-    if(this->GetScene(newScene->GetName()) != nullptr){
+    size_t slot = static_cast<size_t>(newScene->GetKind());
+    if(this->m_scenes[slot] != nullptr){
         return; // this scene already exist and shouldnt be added again
     }
-    this->m_scenes.push_back(newScene);
+    this->m_scenes[slot] = newScene;
     if(m_active_scene == nullptr){
-        this->m_active_scene = newScene; // need to place in active scene as its the only one in existance right now
+        this->Transition(newScene->GetKind()); // first scene in existance becomes the active one
     }
-    return;
-}
-
-std::shared_ptr<GameScene> GameSceneManager::GetActiveScene(){
-    return this->m_active_scene;
-}
-
-string GameSceneManager::GetActiveSceneName(){
-    if(this->m_active_scene == nullptr){return "";} // something to handle missing activate scenes
-    return this->m_active_scene->GetName();
 }
 
 void GameSceneManager::UpdateActiveScene(){
     if(!this->HasScenes()){return;} // make sure we have a scene before we try to paint
     this->m_active_scene->Update();
+    this->TakeTransition();
+}
 
+void GameSceneManager::TakeTransition(){
+    if(!this->HasScenes()){return;}
+    GameSceneKind next;
+    if(this->m_active_scene->TakeTransitionRequest(next)){
+        this->Transition(next);
+    }
 }
 
 void GameSceneManager::DrawActiveScene(){
@@ -144,6 +519,10 @@ void GameIntroScene::Update(){
 }
 
 void GameIntroScene::Draw(){
+    // the banner is all there is, it lives in the cached static layer
+}
+
+void GameIntroScene::DrawStatic(){
     this->m_banner->draw(0,0);
 }
 
@@ -152,7 +531,14 @@ void GameOverScene::Update(){
 }
 
 void GameOverScene::Draw(){
+    // nothing moves on the game over screen, see DrawStatic
+}
+
+void GameOverScene::OnEnter(){
+    ofLogNotice() << "Game over." << std::endl;
+}
+
+void GameOverScene::DrawStatic(){
     ofBackgroundGradient(ofColor::red, ofColor::black);
     this->m_banner->draw(0,0);
-
 }
\ No newline at end of file
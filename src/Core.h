@@ -3,9 +3,21 @@
 #include <utility>
 #include <cmath>
 #include <algorithm>
+#include <limits>
+#include <array>
+#include <atomic>
 #include "ofMain.h"
+#include "MemoryTracker.h"
 
 
+// length of one simulation tick, the app runs as many as fit in the elapsed frame time
+constexpr float kFixedTickSeconds = 1.0f / 60.0f;
+
+// ofLog builds its message (and a module name) on the heap even when the level filters it out, per-tick
+// and per-frame paths check this before logging
+inline bool ShouldLog(ofLogLevel level) { return ofGetLogLevel() <= level; }
+inline bool IsVerboseLogging() { return ShouldLog(OF_LOG_VERBOSE); }
+
 class AwaitFrames {
 public:
 	AwaitFrames(int frames) : m_frames(frames), m_counter(0) {}
@@ -22,31 +34,85 @@ private:
 	int m_counter;
 };
 
+// Collision data derived once from a sprite's alpha channel: a bounding circle and box around the opaque
+// pixels for the broadphase, and a 1 bit per pixel mask packed 64 pixels to a word for the exact test.
+// Everything is relative to the sprite's draw position (its top-left corner).
+class CollisionShape {
+public:
+    static std::shared_ptr<const CollisionShape> FromPixels(const ofPixels& pixels, unsigned char alphaThreshold = 128);
+
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+    glm::vec2 getCenter(bool flipped) const { return flipped ? glm::vec2(m_width - m_center.x, m_center.y) : m_center; }
+    float getRadius() const { return m_radius; }
+    ofRectangle getBounds(bool flipped) const;
+    bool isEmpty() const { return m_radius <= 0.0f; }
+
+    // true when an opaque pixel of a drawn at (ax, ay) lands on one of b drawn at (bx, by)
+    static bool MasksOverlap(const CollisionShape& a, float ax, float ay, bool aFlipped,
+                             const CollisionShape& b, float bx, float by, bool bFlipped);
+
+private:
+    const uint64_t* row(int y, bool flipped) const {
+        return (flipped ? m_mirrored : m_mask).data() + size_t(y) * m_wordsPerRow;
+    }
+    uint64_t bitsAt(const uint64_t* row, int bit) const; // 64 pixels of a row starting at bit, clear outside it
+
+    int m_width = 0;
+    int m_height = 0;
+    int m_wordsPerRow = 0;
+    ofRectangle m_bounds;
+    glm::vec2 m_center{0.0f, 0.0f};
+    float m_radius = 0.0f;
+    std::vector<uint64_t> m_mask;
+    std::vector<uint64_t> m_mirrored; // the mask of the horizontally mirrored image
+    MemoryCharge m_memory;
+};
+
+// Texture-only asset loading: decodes the image, resizes it, uploads it and lets the CPU pixels go, so only the
+// GPU copy stays resident. Callers that need the pixels once at load (collision masks) pass pixelsOut and drop it after.
+bool LoadTextureOnly(ofTexture& texture, const std::string& imagePath, int width, int height, ofPixels* pixelsOut = nullptr);
+
 class GameSprite {
 public:
-    GameSprite(const std::string& imagePath, int width, int height) {
-        if (!m_image.load(imagePath)) {
+    // withCollisionShape keeps the decoded pixels until the alpha mask is built, creatures need it, backdrops
+    // only go to the GPU
+    GameSprite(const std::string& imagePath, int width, int height, bool withCollisionShape = false) : m_width(width), m_height(height) {
+        auto texture = std::make_shared<SpriteTexture>();
+        ofPixels pixels;
+        if (!LoadTextureOnly(texture->texture, imagePath, width, height, withCollisionShape ? &pixels : nullptr)) {
             std::cerr << "Failed to load image: " << imagePath << std::endl;
         }
-        m_image.resize(width, height);
-        m_flippedImage = m_image;
-        m_flippedImage.mirror(false, true); // Mirror horizontally
+        texture->memory.Set(MemoryTag::SPRITES, size_t(width) * height * 4);
+        m_texture = std::move(texture);
+        if (withCollisionShape) {
+            m_shape = CollisionShape::FromPixels(pixels); // the last use of the pixels, they are freed with this scope
+        }
     }
 
-    void draw(float x, float y) const {
-        if (m_flipped) {
-            m_flippedImage.draw(x, y);
+    void draw(float x, float y) const { this->draw(x, y, m_flipped); }
+    void draw(float x, float y, bool flipped) const {
+        if (flipped) {
+            m_texture->texture.draw(x + m_width, y, -m_width, m_height); // mirrored by the quad, no second texture
         } else {
-            m_image.draw(x, y);
+            m_texture->texture.draw(x, y, m_width, m_height);
         }
     }
 
     void setFlipped(bool flipped) { m_flipped = flipped; }
+    bool isFlipped() const { return m_flipped; }
+    const CollisionShape* getCollisionShape() const { return m_shape && !m_shape->isEmpty() ? m_shape.get() : nullptr; }
 
 private:
-    ofImage m_image;
-    ofImage m_flippedImage;
+    struct SpriteTexture {
+        ofTexture texture;
+        MemoryCharge memory;
+    };
+    std::shared_ptr<const SpriteTexture> m_texture; // shared by every copy of the sprite, like the shape
+    float m_width;
+    float m_height;
     bool m_flipped = false;
+    std::shared_ptr<const CollisionShape> m_shape;
 };
 
 
@@ -64,7 +130,9 @@ protected:
     , m_height(0)
     , m_collisionRadius(collisionRadius)
     , m_value(value)
-    , m_sprite(std::move(sprite)) {}
+    , m_sprite(std::move(sprite))
+    , m_sweepX(x)
+    , m_sweepY(y) {}
 
     float m_x = 0.0f;
     float m_y = 0.0f;
@@ -78,13 +146,28 @@ protected:
     std::shared_ptr<GameSprite> m_sprite;
     float m_maxX = 0.0f;
     float m_maxY = 0.0f;
+    // index into the owner's compile-time motion table, -1 for creatures that move themselves through move()
+    int m_motionKind = -1;
+    // where the creature was at the last collision check, collisions are swept from here to (m_x, m_y)
+    float m_sweepX = 0.0f;
+    float m_sweepY = 0.0f;
 
 public:
     virtual ~Creature() = default;
     virtual void move() = 0;
     virtual void draw() const = 0;
 
-    virtual float getCollisionRadius() const { return m_collisionRadius; }
+    // creatures with a sprite collide with its alpha mask, the others (and headless ones) with a circle at (x, y)
+    const CollisionShape* getCollisionShape() const { return m_sprite ? m_sprite->getCollisionShape() : nullptr; }
+    bool isFlipped() const { return m_sprite && m_sprite->isFlipped(); }
+    glm::vec2 getCollisionCenter() const;
+    void beginSweep() { m_sweepX = m_x; m_sweepY = m_y; }
+    glm::vec2 getSweepStart() const { return glm::vec2(m_sweepX, m_sweepY); }
+    void rewindSweep(float t) { m_x = m_sweepX + (m_x - m_sweepX) * t; m_y = m_sweepY + (m_y - m_sweepY) * t; }
+    virtual float getCollisionRadius() const {
+        const CollisionShape* shape = this->getCollisionShape();
+        return shape ? shape->getRadius() : m_collisionRadius;
+    }
     virtual void setCollisionRadius(float radius) { m_collisionRadius = radius; }
 
     float getX() const { return m_x; }
@@ -97,7 +180,9 @@ public:
         }
     }
     void setSprite(std::shared_ptr<GameSprite> sprite) { m_sprite = std::move(sprite); }
+    const GameSprite* getSprite() const { return m_sprite.get(); }
     int getValue() const { return m_value; }
+    int getMotionKind() const { return m_motionKind; }
 
     void setBounds(int w, int h);
     void normalize();
@@ -120,6 +205,7 @@ class GameEvent {
     GameEventType type;
     std::shared_ptr<Creature> creatureA;
     std::shared_ptr<Creature> creatureB; // For collision events
+    float timeOfImpact = 1.0f; // collisions: when they touched, 0 at the previous check to 1 now
     GameEvent() : type(GameEventType::NONE), creatureA(nullptr), creatureB(nullptr) {}
     GameEvent(GameEventType t, std::shared_ptr<Creature> a , std::shared_ptr<Creature> b){
         type = t;
@@ -142,7 +228,182 @@ class GameEvent {
 
 
 
-bool checkCollision(std::shared_ptr<Creature> a, std::shared_ptr<Creature> b);
+// bounding circles first, then the alpha masks when both creatures have one and pixelAccurate is set
+bool checkCollision(const Creature& a, const Creature& b, bool pixelAccurate = true);
+bool checkCollision(std::shared_ptr<Creature> a, std::shared_ptr<Creature> b, bool pixelAccurate = true);
+// Same test swept over both moves since their beginSweep(), so fast movers can't pass through each other between
+// checks. Returns the time of impact in [0, 1] of that interval, or a negative value when they never touch.
+float sweepCollision(const Creature& a, const Creature& b, bool pixelAccurate = true);
+
+
+// Uniform grid over the world for region queries, rebuilt in a single counting-sort pass.
+// Items are indices 0..count-1 into the caller's own array, rebuild whenever that array changes.
+class SpatialGrid {
+public:
+    template <typename PositionOf>
+    void Build(float worldWidth, float worldHeight, float cellSize, int count, PositionOf positionOf) {
+        m_cellSize = cellSize;
+        m_cellsX = std::max(1, int(std::ceil(worldWidth / cellSize)));
+        m_cellsY = std::max(1, int(std::ceil(worldHeight / cellSize)));
+        m_cellStart.assign(size_t(m_cellsX) * m_cellsY + 1, 0);
+        m_itemCell.resize(count);
+        m_items.resize(count);
+        for (int i = 0; i < count; ++i) {
+            glm::vec2 p = positionOf(i);
+            m_itemCell[i] = cellIndex(cellCoord(p.x, m_cellsX), cellCoord(p.y, m_cellsY));
+            ++m_cellStart[m_itemCell[i] + 1];
+        }
+        for (size_t c = 1; c < m_cellStart.size(); ++c) {
+            m_cellStart[c] += m_cellStart[c - 1];
+        }
+        m_fill.assign(m_cellStart.begin(), m_cellStart.end() - 1);
+        for (int i = 0; i < count; ++i) {
+            m_items[m_fill[m_itemCell[i]]++] = i;
+        }
+    }
+
+    // appends every item whose cell overlaps the region, callers do their own exact test if they need one
+    void Query(const ofRectangle& region, std::vector<int>& out) const;
+    void Reserve(int count) { m_items.reserve(count); m_itemCell.reserve(count); } // so Build up to count doesn't allocate
+
+private:
+    int cellCoord(float v, int cells) const { return std::clamp(int(v / m_cellSize), 0, cells - 1); }
+    int cellIndex(int cx, int cy) const { return cy * m_cellsX + cx; }
+
+    float m_cellSize = 1.0f;
+    int m_cellsX = 0;
+    int m_cellsY = 0;
+    std::vector<int> m_cellStart; // items of cell c are m_items[m_cellStart[c] .. m_cellStart[c+1])
+    std::vector<int> m_items;
+    std::vector<int> m_itemCell;
+    std::vector<int> m_fill;
+};
+
+// Coarse grid of steps toward a target, shared by every creature chasing (or running from) the same point.
+// The field is only rebuilt when the target moves into another cell, a lookup is O(1).
+class FlowField {
+public:
+    static constexpr int kUnreached = std::numeric_limits<int>::max();
+
+    void Resize(float worldWidth, float worldHeight, float cellSize); // drops the target, the next SetTarget rebuilds
+    bool SetTarget(float x, float y); // returns true if the field had to be rebuilt
+    bool HasTarget() const { return m_targetCell >= 0; }
+
+    int GetDistance(float x, float y) const; // in cells, kUnreached without a target
+    glm::vec2 GetDirection(float x, float y) const; // unit step toward the target, zero without one
+
+private:
+    void rebuild();
+    int cellOf(float x, float y) const;
+
+    float m_cellSize = 1.0f;
+    int m_cellsX = 0;
+    int m_cellsY = 0;
+    int m_targetCell = -1;
+    glm::vec2 m_target{0.0f, 0.0f};
+    std::vector<int> m_distance;
+    std::vector<glm::vec2> m_direction;
+    std::vector<int> m_frontier;
+};
+
+
+// Layer that rarely changes (backgrounds, title cards), painted once into an FBO and then drawn as a single quad.
+// It repaints on Invalidate(), on a size change, or when the caller's key changes (a level index for example).
+class CachedLayer {
+public:
+    void Invalidate() { m_dirty = true; }
+    void Draw(int width, int height, int key, const std::function<void()>& paint);
+
+private:
+    ofFbo m_fbo;
+    int m_key = 0;
+    bool m_dirty = true;
+};
+
+
+// HUD element bound to one int value (score, lives, ...). The value is polled every frame but the
+// element is only repainted into its own FBO when it changes, otherwise it costs a single quad.
+class HudWidget {
+public:
+    static constexpr int kHidden = std::numeric_limits<int>::min(); // return this from value to hide the widget
+    HudWidget(ofRectangle bounds, std::function<int()> value, std::function<void(int)> paint)
+    : m_bounds(bounds), m_value(std::move(value)), m_paint(std::move(paint)) {}
+    void Draw(float originX, float originY);
+    bool Prepare(); // allocate and repaint if needed without drawing, false while hidden
+    void Invalidate() { m_dirty = true; }
+
+private:
+    ofRectangle m_bounds; // relative to the panel origin, paint draws in widget-local coordinates
+    std::function<int()> m_value;
+    std::function<void(int)> m_paint;
+    ofFbo m_fbo;
+    int m_lastValue = kHidden;
+    bool m_dirty = true;
+};
+
+class HudPanel {
+public:
+    void Add(ofRectangle bounds, std::function<int()> value, std::function<void(int)> paint) {
+        m_widgets.emplace_back(bounds, std::move(value), std::move(paint));
+    }
+    void Draw(float originX, float originY);
+    void Preload(); // allocate every widget's FBO up front
+    void Invalidate();
+
+private:
+    std::vector<HudWidget> m_widgets;
+};
+
+
+// Maps the fixed logical screen (what one screen of the game shows, in world units) onto the window,
+// scaled uniformly and letterboxed. Nothing else knows the window size, so a resize only changes this.
+class ViewProjection {
+public:
+    void SetLogicalSize(float w, float h) { m_logicalWidth = w; m_logicalHeight = h; this->update(); }
+    void SetWindowSize(float w, float h) { m_windowWidth = w; m_windowHeight = h; this->update(); }
+    float GetLogicalWidth() const { return m_logicalWidth; }
+    float GetLogicalHeight() const { return m_logicalHeight; }
+    float GetScale() const { return m_scale; }
+    // everything drawn between Begin and End is in logical screen coordinates
+    void Begin() const;
+    void End() const;
+
+private:
+    void update();
+    float m_logicalWidth = 1.0f;
+    float m_logicalHeight = 1.0f;
+    float m_windowWidth = 1.0f;
+    float m_windowHeight = 1.0f;
+    float m_scale = 1.0f;
+    float m_offsetX = 0.0f;
+    float m_offsetY = 0.0f;
+};
+
+// Window onto a world that can be bigger than one screen, follows a target and stays inside the world.
+// The viewport is in world units, the projection puts it on the window.
+class GameCamera {
+public:
+    void SetWorldSize(float w, float h) { m_worldWidth = w; m_worldHeight = h; }
+    void SetViewportSize(float w, float h) { m_viewWidth = w; m_viewHeight = h; }
+    void SetProjection(const ViewProjection& projection) { m_projection = projection; }
+    const ViewProjection& GetProjection() const { return m_projection; }
+    void Follow(float x, float y);
+    ofRectangle GetViewport() const { return ofRectangle(m_x, m_y, m_viewWidth, m_viewHeight); }
+    // where Follow(x, y) puts the view, without moving it. Only reads the sizes, so the sim thread may call it.
+    ofRectangle GetViewportFor(float x, float y) const;
+    // everything drawn between Begin and End is in world coordinates
+    void Begin() const;
+    void End() const;
+
+private:
+    ViewProjection m_projection;
+    float m_x = 0.0f;
+    float m_y = 0.0f;
+    float m_viewWidth = 0.0f;
+    float m_viewHeight = 0.0f;
+    float m_worldWidth = 0.0f;
+    float m_worldHeight = 0.0f;
+};
 
 
 class GameLevel {
@@ -160,63 +421,99 @@ protected:
 
 
 
-class GameScene {
-    public:
-        virtual string GetName() = 0;
-        virtual void Update() = 0;
-        virtual void Draw() = 0;
-        virtual ~GameScene() = default;
-
-};
-
 enum class GameSceneKind {
     GAME_INTRO,
     AQUARIUM_GAME,
-    GAME_OVER
+    GAME_OVER,
+    COUNT // number of scene kinds, not a scene
 };
 
 string GameSceneKindToString(GameSceneKind t);
 
+class GameScene {
+    public:
+        GameScene(GameSceneKind kind) : m_kind(kind) {}
+        GameSceneKind GetKind() const { return m_kind; }
+        string GetName() { return GameSceneKindToString(m_kind); } // for logs
+        virtual void Update() = 0;
+        virtual void Draw() = 0; // dynamic content, drawn every frame on top of the static layer
+        // static backdrop, the app caches it and only repaints it when GetStaticKey() changes
+        virtual void DrawStatic() {}
+        virtual int GetStaticKey() { return 0; }
+        // called once at the start of every app frame, before anything above. Scenes fed from another thread
+        // pick the state they draw here, so the whole frame shows the same tick.
+        virtual void BeginDraw() {}
+
+        // lifecycle hooks called by the GameSceneManager
+        virtual void Preload() {} // warm up resources, runs once before the scene is first entered
+        virtual void OnEnter() {}
+        virtual void OnExit() {}
+
+        // a scene asks to move on, the manager performs it right after the scene's Update. The request may
+        // come from the sim thread, the manager takes it on the main thread.
+        void RequestTransition(GameSceneKind kind) {
+            m_requestedTransition = kind;
+            m_hasTransitionRequest.store(true, std::memory_order_release);
+        }
+        bool HasTransitionRequest() const { return m_hasTransitionRequest.load(std::memory_order_acquire); }
+        bool TakeTransitionRequest(GameSceneKind& kind) {
+            if (!m_hasTransitionRequest.exchange(false, std::memory_order_acq_rel)) return false;
+            kind = m_requestedTransition;
+            return true;
+        }
+        virtual ~GameScene() = default;
+
+    private:
+        GameSceneKind m_kind;
+        GameSceneKind m_requestedTransition = GameSceneKind::GAME_INTRO;
+        std::atomic<bool> m_hasTransitionRequest{false};
+};
+
 class GameIntroScene : public GameScene {
     public:
-        GameIntroScene(string name, std::shared_ptr<GameSprite> banner)
-        : m_name(name), m_banner(std::move(banner)){};
-        string GetName() override {return this->m_name;}
+        GameIntroScene(GameSceneKind kind, std::shared_ptr<GameSprite> banner)
+        : GameScene(kind), m_banner(std::move(banner)){};
         void Update() override;
         void Draw() override;
+        void DrawStatic() override;
     private:
-        string m_name;
         std::shared_ptr<GameSprite> m_banner;
 };
 
 class GameOverScene : public GameScene {
     public:
-        GameOverScene(string name, std::shared_ptr<GameSprite> banner)
-        : m_name(name), m_banner(std::move(banner)){};
-        string GetName() override {return this->m_name;}
+        GameOverScene(GameSceneKind kind, std::shared_ptr<GameSprite> banner)
+        : GameScene(kind), m_banner(std::move(banner)){};
         void Update() override;
         void Draw() override;
+        void DrawStatic() override;
+        void OnEnter() override;
     private:
-        string m_name;
         std::shared_ptr<GameSprite> m_banner;
 };
 
 
+// Scenes are registered and looked up by kind, one slot each
 class GameSceneManager {
     public:
-        void Transition(string name);
+        void Transition(GameSceneKind kind);
         void AddScene(std::shared_ptr<GameScene> newScene);
-        bool HasScenes(){return m_scenes.size() > 0; }
-        std::shared_ptr<GameScene> GetScene(string name);
-        std::shared_ptr<GameScene> GetActiveScene();
+        void PreloadScene(GameSceneKind kind); // optional, Transition preloads on demand otherwise
+        bool HasScenes(){return m_active_scene != nullptr; }
+        std::shared_ptr<GameScene> GetScene(GameSceneKind kind){ return m_scenes[static_cast<size_t>(kind)]; }
+        std::shared_ptr<GameScene> GetActiveScene(){ return m_active_scene; }
         
         // support the functionality
-        string GetActiveSceneName();
+        GameSceneKind GetActiveSceneKind(){ return m_active_kind; }
         void UpdateActiveScene();
+        void TakeTransition(); // only performs a requested transition, for scenes ticked on another thread
         void DrawActiveScene();
 
     private:
-        std::vector<std::shared_ptr<GameScene>> m_scenes;
+        static constexpr size_t kSceneCount = static_cast<size_t>(GameSceneKind::COUNT);
+        std::array<std::shared_ptr<GameScene>, kSceneCount> m_scenes;
+        std::array<bool, kSceneCount> m_preloaded{};
         std::shared_ptr<GameScene> m_active_scene;
+        GameSceneKind m_active_kind = GameSceneKind::GAME_INTRO;
 
 };
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include "FrameArena.h"
+
+
+FrameArena::FrameArena(size_t blockBytes) : m_blockBytes(std::max<size_t>(blockBytes, 1024)) {
+    m_blocks.push_back({std::make_unique<std::byte[]>(m_blockBytes), m_blockBytes});
+}
+
+void* FrameArena::Allocate(size_t bytes, size_t alignment) {
+    while (true) {
+        Block& block = m_blocks[m_current];
+        size_t start = (m_offset + alignment - 1) & ~(alignment - 1);
+        if (start + bytes <= block.size) {
+            m_offset = start + bytes;
+            m_used += bytes;
+            m_peak = std::max(m_peak, m_used);
+            return block.memory.get() + start;
+        }
+        // on to the next block, adding one if this tick is the busiest yet
+        if (m_current + 1 == m_blocks.size()) {
+            size_t size = std::max(m_blockBytes, bytes + alignment);
+            m_blocks.push_back({std::make_unique<std::byte[]>(size), size});
+            ++m_growths;
+        }
+        ++m_current;
+        m_offset = 0;
+    }
+}
+
+void FrameArena::Reset() {
+    m_current = 0;
+    m_offset = 0;
+    m_used = 0;
+}
+
+size_t FrameArena::GetCapacityBytes() const {
+    size_t total = 0;
+    for (const Block& block : m_blocks) {
+        total += block.size;
+    }
+    return total;
+}
+
+string FrameArena::Report() const {
+    std::ostringstream out;
+    out << "frame arena peak " << m_peak / 1024 << " kb of " << this->GetCapacityBytes() / 1024
+        << " kb, grew " << m_growths << " times";
+    return out.str();
+}
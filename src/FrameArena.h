@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "ofMain.h"
+
+// Bump-pointer memory for what only lives during one simulation tick (scratch lists, the tick's collision
+// event). Reset() at the start of the next tick takes all of it back at once, nothing is freed one by one and
+// destructors are the owners' business. A tick that needs more than there is adds a block, blocks are kept,
+// so once the busy ticks have been seen the arena doesn't touch the heap any more.
+class FrameArena {
+public:
+    explicit FrameArena(size_t blockBytes = kDefaultBlockBytes);
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* Allocate(size_t bytes, size_t alignment);
+    void Reset();
+
+    size_t GetUsedBytes() const { return m_used; }
+    size_t GetPeakBytes() const { return m_peak; } // most any tick used
+    size_t GetCapacityBytes() const;
+    uint64_t GetGrowths() const { return m_growths; } // blocks added past the first
+    string Report() const;
+
+    static constexpr size_t kDefaultBlockBytes = 64 * 1024;
+
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> memory;
+        size_t size;
+    };
+
+    std::vector<Block> m_blocks;
+    size_t m_blockBytes;
+    size_t m_current = 0; // the block we bump in
+    size_t m_offset = 0;
+    size_t m_used = 0;
+    size_t m_peak = 0;
+    uint64_t m_growths = 0;
+};
+
+// Standard allocator over a FrameArena, deallocate is a no-op. Containers using it must not outlive the tick.
+template <typename T>
+struct ArenaAllocator {
+    using value_type = T;
+    FrameArena* arena;
+
+    explicit ArenaAllocator(FrameArena& a) : arena(&a) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(arena->Allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T*, size_t) {}
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+// shared_ptr whose object and control block sit in the arena, for handing a tick's data around by the
+// usual pointer type. The last reference has to go before the arena's next Reset().
+template <typename T, typename... Args>
+std::shared_ptr<T> MakeInArena(FrameArena& arena, Args&&... args) {
+    return std::allocate_shared<T>(ArenaAllocator<T>(arena), std::forward<Args>(args)...);
+}
@@ -0,0 +1,205 @@
+#include "FrameCapture.h"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+
+
+void FrameCapture::Load(const string& settingsPath) {
+    ofXml settings;
+    if (!settings.load(settingsPath)) return;
+    if (auto format = settings.getChild("group").getChild("capture_format")) {
+        m_format = format.getValue() == "raw" ? Format::RAW : Format::PNG;
+    }
+}
+
+void FrameCapture::Start(int width, int height) {
+    this->Stop();
+    m_width = width;
+    m_height = height;
+    size_t frameBytes = size_t(width) * height * 4;
+
+    std::filesystem::create_directories(ofToDataPath("capture"));
+    if (m_format == Format::RAW) {
+        m_path = ofToDataPath("capture/" + ofGetTimestampString() + "-" + ofToString(width) + "x" + ofToString(height) + ".rgba");
+        m_raw.open(m_path, std::ios::binary);
+        if (!m_raw) {
+            ofLogError() << "Capture: can't write " << m_path;
+            return;
+        }
+        m_timestamps.open(m_path + ".txt");
+    } else {
+        m_path = ofToDataPath("capture/" + ofGetTimestampString());
+        std::filesystem::create_directories(m_path);
+        m_timestamps.open(m_path + "/timestamps.txt");
+    }
+    // dropped frames leave gaps, players have to go by these times rather than a fixed frame rate
+    m_timestamps << "# frame microseconds_since_start\n";
+
+#ifdef TARGET_OPENGLES
+    m_fences = false;
+#else
+    m_fences = GLEW_VERSION_3_2 || GLEW_ARB_sync;
+#endif
+    if (!m_fences) {
+        ofLogWarning() << "Capture: no GL sync objects (GL 3.2 or ARB_sync), frames are mapped " << kReadbacks << " frames late without checking";
+    }
+
+    for (Readback& readback : m_readbacks) {
+        readback.pbo.allocate(frameBytes, GL_STREAM_READ);
+    }
+    for (int i = 0; i < int(kBuffers); ++i) {
+        m_buffers[i].resize(frameBytes);
+        m_freeBuffers.Push(i);
+    }
+    m_memory.Set(MemoryTag::CAPTURE, (kReadbacks + kBuffers) * frameBytes);
+    m_nextReadback = 0;
+    m_frame = 0;
+    m_stats = CaptureStats();
+    m_written = 0;
+    m_startTime = std::chrono::steady_clock::now();
+
+    m_encoding.store(true, std::memory_order_release);
+    m_encoder = std::thread([this]() { this->encode(); });
+    m_recording = true;
+    ofLogNotice() << "Capture: recording " << width << "x" << height << " to " << m_path;
+}
+
+void FrameCapture::Stop() {
+    if (!m_recording) return;
+    m_recording = false;
+    // the readbacks still in flight are the last frames, wait for those rather than lose them
+    for (size_t i = 0; i < kReadbacks; ++i) {
+        Readback& readback = m_readbacks[(m_nextReadback + i) % kReadbacks];
+        if (readback.pending) {
+            this->collect(readback, true);
+        }
+    }
+    m_encoding.store(false, std::memory_order_release);
+    m_encoder.join(); // drains its queue first
+    m_raw.close();
+    m_timestamps.close();
+
+    Job job;
+    while (m_toEncoder.Pop(job)) {}
+    int buffer;
+    while (m_freeBuffers.Pop(buffer)) {}
+    for (auto& pixels : m_buffers) {
+        pixels = std::vector<unsigned char>();
+    }
+    for (Readback& readback : m_readbacks) {
+        readback.pbo = ofBufferObject();
+    }
+    m_memory.Set(MemoryTag::CAPTURE, 0);
+    ofLogNotice() << "Capture: stopped, " << this->Report();
+}
+
+bool FrameCapture::collect(Readback& readback, bool wait) {
+    if (readback.fence) {
+        GLenum status = glClientWaitSync(readback.fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? GLuint64(1000000000) : 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            return false;
+        }
+        glDeleteSync(readback.fence);
+        readback.fence = nullptr;
+    }
+    readback.pending = false;
+
+    int buffer;
+    if (!m_freeBuffers.Pop(buffer)) {
+        ++m_stats.dropped; // the encoder is behind
+        return true;
+    }
+    const unsigned char* mapped = readback.pbo.map<unsigned char>(GL_READ_ONLY);
+    if (mapped) {
+        std::memcpy(m_buffers[buffer].data(), mapped, m_buffers[buffer].size());
+    }
+    readback.pbo.unmap();
+    m_toEncoder.Push({buffer, m_frame++, readback.micros});
+    ++m_stats.captured;
+    return true;
+}
+
+void FrameCapture::CaptureFrame() {
+    if (!m_recording) return;
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point start = Clock::now();
+
+    if (ofGetWidth() != m_width || ofGetHeight() != m_height) {
+        ofLogWarning() << "Capture: the window changed size, stopping";
+        this->Stop();
+        return;
+    }
+
+    // the oldest readback has to be out of the way before this frame can take its slot
+    Readback& readback = m_readbacks[m_nextReadback];
+    if (readback.pending && !this->collect(readback, false)) {
+        ++m_stats.dropped; // the GPU hasn't finished a frame from kReadbacks ago, skip this one
+    } else {
+        readback.pbo.bind(GL_PIXEL_PACK_BUFFER);
+        glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr); // into the bound buffer, returns at once
+        readback.pbo.unbind(GL_PIXEL_PACK_BUFFER);
+        readback.fence = m_fences ? glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) : nullptr;
+        readback.pending = true;
+        readback.micros = std::chrono::duration_cast<std::chrono::microseconds>(start - m_startTime).count();
+        m_nextReadback = (m_nextReadback + 1) % kReadbacks;
+    }
+
+    float millis = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+    ++m_stats.frames;
+    m_stats.lastMillis = millis;
+    m_stats.avgMillis += (millis - m_stats.avgMillis) / float(m_stats.frames);
+    m_stats.maxMillis = std::max(m_stats.maxMillis, millis);
+}
+
+void FrameCapture::encode() {
+    Job job;
+    while (true) {
+        if (!m_toEncoder.Pop(job)) {
+            if (!m_encoding.load(std::memory_order_acquire)) {
+                // Stop() collects the last readbacks before clearing the flag, one more look for those
+                if (!m_toEncoder.Pop(job)) return;
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+        }
+        this->write(m_buffers[job.buffer], job.frame, job.micros);
+        m_freeBuffers.Push(job.buffer);
+        m_written.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void FrameCapture::write(const std::vector<unsigned char>& pixels, uint64_t frame, uint64_t micros) {
+    m_timestamps << frame << " " << micros << "\n";
+    // GL reads bottom-up, both outputs are top-down
+    size_t rowBytes = size_t(m_width) * 4;
+    if (m_format == Format::RAW) {
+        for (int y = m_height - 1; y >= 0; --y) {
+            m_raw.write(reinterpret_cast<const char*>(pixels.data() + y * rowBytes), rowBytes);
+        }
+        return;
+    }
+    ofPixels image;
+    image.setFromPixels(pixels.data(), m_width, m_height, OF_PIXELS_RGBA);
+    image.mirror(true, false);
+    char name[32];
+    std::snprintf(name, sizeof(name), "/frame-%06llu.png", static_cast<unsigned long long>(frame));
+    ofSaveImage(image, m_path + name);
+}
+
+CaptureStats FrameCapture::GetStats() const {
+    CaptureStats stats = m_stats;
+    stats.written = m_written.load(std::memory_order_relaxed);
+    return stats;
+}
+
+string FrameCapture::Report() const {
+    CaptureStats stats = this->GetStats();
+    std::ostringstream out;
+    out.setf(std::ios::fixed);
+    out.precision(2);
+    out << "capture " << (m_recording ? "on" : "off") << " captured " << stats.captured << " written " << stats.written
+        << " dropped " << stats.dropped << " | ms/frame avg " << stats.avgMillis << " last " << stats.lastMillis
+        << " max " << stats.maxMillis << (m_fences ? "" : " (no GL fences)");
+    return out.str();
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include "ofMain.h"
+#include "MemoryTracker.h"
+#include "SimThread.h"
+
+struct CaptureStats {
+    uint64_t frames = 0;    // CaptureFrame calls while recording
+    uint64_t captured = 0;  // frames handed to the encoder
+    uint64_t dropped = 0;   // the readback ring or the encoder was behind, the frame was skipped
+    uint64_t written = 0;   // frames the encoder finished
+    float lastMillis = 0.0f; // main thread time CaptureFrame cost
+    float avgMillis = 0.0f;
+    float maxMillis = 0.0f;
+};
+
+// Records what the game draws without stalling the frame. Each frame is read back into a pixel buffer
+// object and only mapped a few frames later, once its fence says the GPU is done, then copied into a pooled
+// buffer for the encoder thread, which writes numbered PNGs or one raw RGBA stream. Whenever a step would
+// have to wait (readback not finished, no free buffer) the frame is dropped instead, so every recording comes
+// with a timestamps file giving each written frame's capture time. Fences need GL 3.2 or ARB_sync, without
+// them a readback is mapped when its slot comes around again, kReadbacks frames later, and may block there.
+class FrameCapture {
+public:
+    enum class Format {
+        PNG, // data/capture/<timestamp>/frame-000000.png, times in timestamps.txt next to them
+        RAW, // data/capture/<timestamp>-<w>x<h>.rgba, top-down rgba frames back to back, times in <that>.txt
+    };
+
+    ~FrameCapture() { Stop(); }
+    void Load(const string& settingsPath); // <capture_format> png or raw
+    void Start(int width, int height);
+    void Stop(); // finishes the readbacks in flight and everything queued for the encoder
+    bool IsRecording() const { return m_recording; }
+
+    void CaptureFrame(); // main thread, right after the frame is drawn
+
+    CaptureStats GetStats() const;
+    string Report() const;
+
+private:
+    static constexpr size_t kReadbacks = 3; // frames in flight on the GPU
+    static constexpr size_t kBuffers = 8;   // frames the encoder may be behind
+
+    struct Readback {
+        ofBufferObject pbo;
+        GLsync fence = nullptr; // null when pending without fences
+        bool pending = false;
+        uint64_t micros = 0; // since Start, when the frame was drawn
+    };
+    struct Job {
+        int buffer;
+        uint64_t frame;
+        uint64_t micros;
+    };
+
+    bool collect(Readback& readback, bool wait); // false when the readback isn't finished yet
+    void encode();
+    void write(const std::vector<unsigned char>& pixels, uint64_t frame, uint64_t micros);
+
+    Format m_format = Format::PNG;
+    bool m_recording = false;
+    int m_width = 0;
+    int m_height = 0;
+    string m_path;
+    std::ofstream m_raw;
+    std::ofstream m_timestamps; // "<frame> <microseconds>" per written frame, encoder thread only
+    bool m_fences = false;
+    std::chrono::steady_clock::time_point m_startTime;
+
+    std::array<Readback, kReadbacks> m_readbacks;
+    size_t m_nextReadback = 0;
+    uint64_t m_frame = 0;
+
+    std::array<std::vector<unsigned char>, kBuffers> m_buffers;
+    SpscQueue<Job, kBuffers> m_toEncoder;
+    SpscQueue<int, kBuffers> m_freeBuffers;
+    std::thread m_encoder;
+    std::atomic<bool> m_encoding{false};
+    std::atomic<uint64_t> m_written{0};
+    MemoryCharge m_memory;
+
+    CaptureStats m_stats;
+};
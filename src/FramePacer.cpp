@@ -0,0 +1,162 @@
+#include "FramePacer.h"
+#include <fstream>
+#include "ofMainLoop.h"
+
+
+string FramePacingModeToString(FramePacingMode mode){
+    switch(mode){
+        case FramePacingMode::VSYNC: return "vsync";
+        case FramePacingMode::FIXED_CAP: return "cap";
+        case FramePacingMode::UNCAPPED: return "uncapped";
+        case FramePacingMode::LOW_LATENCY: return "low_latency";
+        default: return "unknown";
+    }
+}
+
+FramePacingMode FramePacingModeFromString(const string& name, FramePacingMode fallback){
+    for(int i = 0; i < int(FramePacingMode::COUNT); ++i){
+        if(FramePacingModeToString(FramePacingMode(i)) == name){
+            return FramePacingMode(i);
+        }
+    }
+    return fallback;
+}
+
+
+void FrameTimeHistogram::Add(float millis, float budgetMillis) {
+    size_t bucket = std::min(kBuckets - 1, size_t(std::max(0.0f, millis) / kBucketMillis));
+    ++m_buckets[bucket];
+    ++m_count;
+    if (millis > budgetMillis) ++m_hitches;
+    m_maxMillis = std::max(m_maxMillis, millis);
+}
+
+void FrameTimeHistogram::Clear() {
+    m_buckets.fill(0);
+    m_count = 0;
+    m_hitches = 0;
+    m_maxMillis = 0.0f;
+}
+
+float FrameTimeHistogram::PercentileMillis(float percentile) const {
+    if (m_count == 0) return 0.0f;
+    uint64_t rank = uint64_t(percentile * (m_count - 1));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        seen += m_buckets[i];
+        if (seen > rank) {
+            return (i + 1) * kBucketMillis; // upper edge of the bucket
+        }
+    }
+    return m_maxMillis;
+}
+
+bool FrameTimeHistogram::WriteCsv(const string& path) const {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "bucket_ms,frames\n";
+    for (size_t i = 0; i < kBuckets; ++i) {
+        if (m_buckets[i] > 0) {
+            out << i * kBucketMillis << "," << m_buckets[i] << "\n";
+        }
+    }
+    return true;
+}
+
+
+void FramePacer::Load(const string& settingsPath) {
+    ofXml settings;
+    if (!settings.load(settingsPath)) {
+        ofLogWarning("FramePacer") << "could not read " << settingsPath << ", using defaults";
+        this->SetMode(m_mode);
+        return;
+    }
+    auto group = settings.getChild("group");
+    if (auto cap = group.getChild("frame_cap")) {
+        m_targetFps = std::max(1, cap.getIntValue());
+    }
+    if (auto pacing = group.getChild("frame_pacing")) {
+        m_mode = FramePacingModeFromString(pacing.getValue(), m_mode);
+    }
+    this->SetMode(m_mode);
+}
+
+void FramePacer::SetTargetFps(int fps) {
+    m_targetFps = std::max(1, fps);
+    this->SetMode(m_mode);
+}
+
+void FramePacer::SetMode(FramePacingMode mode) {
+    m_mode = mode;
+    switch (mode) {
+        case FramePacingMode::VSYNC:
+            ofSetVerticalSync(true);
+            ofSetFrameRate(0);
+            break;
+        case FramePacingMode::FIXED_CAP:
+            ofSetVerticalSync(false);
+            ofSetFrameRate(m_targetFps);
+            break;
+        case FramePacingMode::UNCAPPED:
+        case FramePacingMode::LOW_LATENCY: // we do our own sleeping in BeginFrame
+            ofSetVerticalSync(false);
+            ofSetFrameRate(0);
+            break;
+        default:
+            break;
+    }
+    m_nextDeadlineMicros = 0;
+    m_histogram.Clear(); // numbers from different modes don't mix
+    ofLogNotice("FramePacer") << "pacing mode " << FramePacingModeToString(mode) << " at " << m_targetFps << " fps";
+}
+
+void FramePacer::SleepUntil(uint64_t deadlineMicros) const {
+    uint64_t now = ofGetElapsedTimeMicros();
+    // sleep coarsely, then spin the last stretch, OS sleeps overshoot by a millisecond or more
+    if (deadlineMicros > now + 2000) {
+        std::this_thread::sleep_for(std::chrono::microseconds(deadlineMicros - now - 2000));
+    }
+    while (ofGetElapsedTimeMicros() < deadlineMicros) {
+        std::this_thread::yield();
+    }
+}
+
+void FramePacer::BeginFrame() {
+    uint64_t budgetMicros = 1000000 / m_targetFps;
+    if (m_mode == FramePacingMode::LOW_LATENCY) {
+        uint64_t now = ofGetElapsedTimeMicros();
+        if (m_nextDeadlineMicros == 0 || now > m_nextDeadlineMicros + budgetMicros) {
+            m_nextDeadlineMicros = now + budgetMicros; // first frame or we fell behind, restart the schedule
+        }
+        // wake up just early enough to sample input, simulate and draw before the deadline
+        uint64_t wake = m_nextDeadlineMicros - std::min<uint64_t>(budgetMicros, uint64_t(m_workMicros + kWakeMarginMicros));
+        this->SleepUntil(wake);
+        m_nextDeadlineMicros += budgetMicros;
+        // openFrameworks polled events before calling update, anything that came in while we slept would wait
+        // a whole frame. Poll again so the keys reach the sampler before this frame consumes them.
+        ofGetMainLoop()->pollEvents();
+    }
+
+    uint64_t now = ofGetElapsedTimeMicros();
+    if (m_frameStartMicros != 0) {
+        m_histogram.Add((now - m_frameStartMicros) / 1000.0f, 1000.0f / m_targetFps);
+    }
+    m_frameStartMicros = now;
+}
+
+void FramePacer::EndFrame() {
+    float work = float(ofGetElapsedTimeMicros() - m_frameStartMicros);
+    m_workMicros = m_workMicros == 0.0f ? work : m_workMicros * 0.9f + work * 0.1f;
+}
+
+string FramePacer::Report() const {
+    std::ostringstream out;
+    out.setf(std::ios::fixed);
+    out.precision(2);
+    out << "frame ms [" << FramePacingModeToString(m_mode) << "] p50 " << m_histogram.PercentileMillis(0.5f)
+        << " p95 " << m_histogram.PercentileMillis(0.95f)
+        << " p99 " << m_histogram.PercentileMillis(0.99f)
+        << " max " << m_histogram.GetMaxMillis()
+        << " hitches " << m_histogram.GetHitches() << "/" << m_histogram.GetCount();
+    return out.str();
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "ofMain.h"
+
+enum class FramePacingMode {
+    VSYNC,       // present on the display refresh
+    FIXED_CAP,   // no vsync, openFrameworks caps the frame rate
+    UNCAPPED,    // no vsync, no cap
+    LOW_LATENCY, // no vsync, sleep until just before the frame deadline, then poll events again and run
+    COUNT
+};
+
+string FramePacingModeToString(FramePacingMode mode);
+FramePacingMode FramePacingModeFromString(const string& name, FramePacingMode fallback);
+
+// Frame times in fixed 0.25 ms buckets up to 100 ms (anything slower lands in the last one)
+class FrameTimeHistogram {
+public:
+    static constexpr float kBucketMillis = 0.25f;
+    static constexpr size_t kBuckets = 400;
+
+    void Add(float millis, float budgetMillis);
+    void Clear();
+    float PercentileMillis(float percentile) const; // percentile in [0, 1], bucket resolution
+    float GetMaxMillis() const { return m_maxMillis; }
+    uint64_t GetCount() const { return m_count; }
+    uint64_t GetHitches() const { return m_hitches; } // frames over the budget
+    bool WriteCsv(const string& path) const;
+
+private:
+    std::array<uint32_t, kBuckets> m_buckets{};
+    uint64_t m_count = 0;
+    uint64_t m_hitches = 0;
+    float m_maxMillis = 0.0f;
+};
+
+// Owns how frames are paced and keeps the frame-time histogram.
+// Call BeginFrame() first thing in ofApp::update and EndFrame() at the end of ofApp::draw. In low latency mode
+// BeginFrame polls the window events after its sleep, so key callbacks can run from inside it.
+class FramePacer {
+public:
+    void Load(const string& settingsPath); // <frame_pacing> and <frame_cap> from the settings file
+    void SetMode(FramePacingMode mode);
+    void CycleMode() { SetMode(FramePacingMode((int(m_mode) + 1) % int(FramePacingMode::COUNT))); }
+    FramePacingMode GetMode() const { return m_mode; }
+    void SetTargetFps(int fps);
+
+    void BeginFrame();
+    void EndFrame();
+
+    const FrameTimeHistogram& GetHistogram() const { return m_histogram; }
+    void ResetHistogram() { m_histogram.Clear(); }
+    string Report() const;
+
+private:
+    void SleepUntil(uint64_t deadlineMicros) const;
+
+    FramePacingMode m_mode = FramePacingMode::VSYNC;
+    int m_targetFps = 60;
+    uint64_t m_frameStartMicros = 0;
+    uint64_t m_nextDeadlineMicros = 0;
+    float m_workMicros = 0.0f; // smoothed update + draw cost, low latency mode wakes up this much early
+    FrameTimeHistogram m_histogram;
+    static constexpr float kWakeMarginMicros = 1500.0f; // covers sleep jitter and the buffer swap
+};
@@ -0,0 +1,120 @@
+#include "InputSampler.h"
+
+
+void LatencySamples::Add(uint64_t micros) {
+    if (m_samples.size() < kWindow) {
+        m_samples.push_back(micros);
+        return;
+    }
+    m_samples[m_next] = micros; // window is full, overwrite the oldest
+    m_next = (m_next + 1) % kWindow;
+}
+
+float LatencySamples::PercentileMillis(float percentile) const {
+    if (m_samples.empty()) return 0.0f;
+    m_sorted = m_samples;
+    size_t rank = std::min(m_sorted.size() - 1, size_t(percentile * (m_sorted.size() - 1) + 0.5f));
+    std::nth_element(m_sorted.begin(), m_sorted.begin() + rank, m_sorted.end());
+    return m_sorted[rank] / 1000.0f;
+}
+
+
+bool InputTickState::Apply(const InputEdge& edge) {
+    uint32_t bit = 1u << static_cast<int>(edge.key);
+    if (m_touched & bit) return false;
+    m_touched |= bit;
+    m_held = edge.pressed ? (m_held | bit) : (m_held & ~bit);
+    return true;
+}
+
+InputFrame InputTickState::EndTick() {
+    InputFrame frame;
+    frame.held = m_held;
+    frame.changed = m_held != m_previous;
+    m_previous = m_held;
+    m_touched = 0;
+    return frame;
+}
+
+
+bool InputSampler::MapKey(int ofKey, InputKey& key) {
+    switch (ofKey) {
+        case OF_KEY_UP: key = InputKey::UP; return true;
+        case OF_KEY_DOWN: key = InputKey::DOWN; return true;
+        case OF_KEY_LEFT: key = InputKey::LEFT; return true;
+        case OF_KEY_RIGHT: key = InputKey::RIGHT; return true;
+        default: return false;
+    }
+}
+
+void InputSampler::Queue(int ofKey, bool pressed) {
+    InputKey key;
+    if (!MapKey(ofKey, key)) return;
+    uint32_t bit = 1u << static_cast<int>(key);
+    bool wasHeld = (m_queuedHeld & bit) != 0;
+    if (wasHeld == pressed) return; // OS key repeat, nothing changed
+    m_queuedHeld = pressed ? (m_queuedHeld | bit) : (m_queuedHeld & ~bit);
+    m_queue.push_back({key, pressed, ofGetElapsedTimeMicros()});
+}
+
+void InputSampler::KeyPressed(int ofKey) {
+    this->Queue(ofKey, true);
+}
+
+void InputSampler::KeyReleased(int ofKey) {
+    this->Queue(ofKey, false);
+}
+
+InputFrame InputSampler::ConsumeTick() {
+    uint64_t now = ofGetElapsedTimeMicros();
+    size_t consumed = 0;
+    while (consumed < m_queue.size() && m_tick.Apply(m_queue[consumed])) {
+        this->EdgeConsumed(m_queue[consumed].stampMicros, now);
+        ++consumed;
+    }
+    m_queue.erase(m_queue.begin(), m_queue.begin() + consumed);
+    return m_tick.EndTick();
+}
+
+void InputSampler::ForwardEdges(const std::function<bool(const InputEdge&)>& push) {
+    size_t forwarded = 0;
+    while (forwarded < m_queue.size() && push(m_queue[forwarded])) {
+        ++forwarded;
+    }
+    m_queue.erase(m_queue.begin(), m_queue.begin() + forwarded);
+}
+
+void InputSampler::EdgeConsumed(uint64_t stampMicros, uint64_t consumedMicros) {
+    m_inputToSim.Add(consumedMicros - stampMicros);
+    m_awaitingPresent.push_back(stampMicros);
+}
+
+void InputSampler::FramePresented() {
+    if (m_awaitingPresent.empty()) return;
+    uint64_t now = ofGetElapsedTimeMicros();
+    for (uint64_t stamp : m_awaitingPresent) {
+        m_inputToPresent.Add(now - stamp);
+    }
+    m_awaitingPresent.clear();
+}
+
+void InputSampler::Reset() {
+    m_queue.clear();
+    m_awaitingPresent.clear();
+    m_queuedHeld = 0;
+    m_tick.Reset();
+}
+
+std::string InputSampler::Report() const {
+    std::ostringstream out;
+    out.setf(std::ios::fixed);
+    out.precision(1);
+    out << "input->sim ms p50 " << m_inputToSim.PercentileMillis(0.5f)
+        << " p95 " << m_inputToSim.PercentileMillis(0.95f)
+        << " p99 " << m_inputToSim.PercentileMillis(0.99f)
+        << " | input->present ms p50 " << m_inputToPresent.PercentileMillis(0.5f)
+        << " p95 " << m_inputToPresent.PercentileMillis(0.95f)
+        << " p99 " << m_inputToPresent.PercentileMillis(0.99f)
+        << " (" << m_inputToPresent.Count() << " samples)";
+    return out.str();
+}
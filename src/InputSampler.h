@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "ofMain.h"
+
+// Keys the simulation cares about, one bit each in InputFrame::held
+enum class InputKey {
+    UP,
+    DOWN,
+    LEFT,
+    RIGHT,
+    COUNT
+};
+
+// What the simulation sees on one fixed tick
+struct InputFrame {
+    uint32_t held = 0;    // bit per InputKey
+    bool changed = false; // held differs from the previous tick
+    bool IsHeld(InputKey key) const { return (held & (1u << static_cast<int>(key))) != 0; }
+};
+
+// One key going down or up, stamped when the window reported it
+struct InputEdge {
+    InputKey key = InputKey::UP;
+    bool pressed = false;
+    uint64_t stampMicros = 0;
+};
+
+// Folds key edges into per-tick key state, in order. A tick takes edges until one would undo a key it already
+// changed, that one and everything after it waits for the next tick, so a tap shorter than a tick is still
+// held for one.
+class InputTickState {
+public:
+    bool Apply(const InputEdge& edge); // false when the edge belongs to the next tick, nothing is applied
+    InputFrame EndTick();
+    void Reset() { *this = InputTickState(); }
+
+private:
+    uint32_t m_held = 0;
+    uint32_t m_previous = 0; // what the last tick saw
+    uint32_t m_touched = 0;  // keys changed this tick
+};
+
+// Rolling window of the most recent latency samples, in microseconds
+class LatencySamples {
+public:
+    void Add(uint64_t micros);
+    float PercentileMillis(float percentile) const; // percentile in [0, 1]
+    size_t Count() const { return m_samples.size(); }
+
+private:
+    static constexpr size_t kWindow = 1024;
+    std::vector<uint64_t> m_samples;
+    size_t m_next = 0;
+    mutable std::vector<uint64_t> m_sorted;
+};
+
+// Key events are stamped and queued as they arrive from the window, the simulation drains them once per
+// fixed tick into a key-state bitmask. That keeps movement independent from the OS key-repeat rate, and the
+// stamps give input-to-sim (consumed by a tick) and input-to-present (first frame drawn after that) latency.
+// With the sim on its own thread the edges are forwarded to it instead, and the thread reports back when a
+// tick consumed them.
+class InputSampler {
+public:
+    void KeyPressed(int ofKey);
+    void KeyReleased(int ofKey);
+    InputFrame ConsumeTick(); // once per fixed simulation tick
+    // hands the queued edges to push in order, stopping at the first it refuses (those stay queued)
+    void ForwardEdges(const std::function<bool(const InputEdge&)>& push);
+    void EdgeConsumed(uint64_t stampMicros, uint64_t consumedMicros); // a forwarded edge reached a tick
+    void FramePresented();    // once per frame, after the scene is drawn
+    void Reset();             // drop held keys, e.g. when leaving the game scene
+
+    const LatencySamples& GetInputToSim() const { return m_inputToSim; }
+    const LatencySamples& GetInputToPresent() const { return m_inputToPresent; }
+    std::string Report() const;
+
+private:
+    static bool MapKey(int ofKey, InputKey& key);
+    void Queue(int ofKey, bool pressed);
+
+    std::vector<InputEdge> m_queue; // filled by key callbacks, drained by ConsumeTick or ForwardEdges
+    std::vector<uint64_t> m_awaitingPresent; // stamps consumed by a tick but not drawn yet
+    uint32_t m_queuedHeld = 0; // state after every queued edge, used to drop key repeats
+    InputTickState m_tick;     // state the simulation last saw
+    LatencySamples m_inputToSim;
+    LatencySamples m_inputToPresent;
+};
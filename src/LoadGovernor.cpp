@@ -0,0 +1,55 @@
+#include "LoadGovernor.h"
+
+
+void LoadGovernor::Load(const string& settingsPath) {
+    ofXml settings;
+    if (!settings.load(settingsPath)) return;
+    auto group = settings.getChild("group");
+    if (auto target = group.getChild("target_frame_ms")) {
+        this->SetTargetMillis(std::max(0.0f, target.getFloatValue()));
+    }
+    if (auto minScale = group.getChild("min_load_scale")) {
+        this->SetMinScale(minScale.getFloatValue());
+    }
+}
+
+bool LoadGovernor::AddFrame(float costMillis, float frameSeconds) {
+    if (m_targetMillis <= 0.0f) return false;
+    m_averageMillis += (costMillis - m_averageMillis) * 0.1f;
+
+    if (m_settleSeconds > 0.0f) {
+        m_settleSeconds -= frameSeconds;
+        return false;
+    }
+    m_overSeconds = m_averageMillis > m_targetMillis ? m_overSeconds + frameSeconds : 0.0f;
+    m_underSeconds = m_averageMillis < m_targetMillis * kHeadroom ? m_underSeconds + frameSeconds : 0.0f;
+
+    float scale = m_scale;
+    if (m_overSeconds >= kDownAfterSeconds) {
+        scale = std::max(m_minScale, m_scale * kStepDown);
+    } else if (m_underSeconds >= kUpAfterSeconds) {
+        scale = std::min(1.0f, m_scale * kStepUp);
+    }
+    if (scale == m_scale) return false;
+
+    ofLogNotice() << "Load governor: " << m_averageMillis << " ms against " << m_targetMillis << " ms, load scale " << m_scale << " -> " << scale;
+    m_scale = scale;
+    m_overSeconds = 0.0f;
+    m_underSeconds = 0.0f;
+    m_settleSeconds = kSettleSeconds;
+    ++m_changes;
+    return true;
+}
+
+string LoadGovernor::Report() const {
+    std::ostringstream out;
+    out.setf(std::ios::fixed);
+    out.precision(2);
+    out << "load scale " << m_scale << " cost ms " << m_averageMillis;
+    if (m_targetMillis > 0.0f) {
+        out << " target " << m_targetMillis << " changes " << m_changes;
+    } else {
+        out << " (governor off)";
+    }
+    return out.str();
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "ofMain.h"
+
+// Holds a frame time target by scaling how much the game simulates and draws. Every frame reports what its
+// work cost, and after a full window over budget the load scale steps down, after a longer window well under
+// budget it steps back up. Nothing changes again until the last change has had time to show in the numbers.
+// The scale applies to level populations, particle budgets and boss projectiles, never to score targets.
+class LoadGovernor {
+public:
+    static constexpr float kStepDown = 0.85f;
+    static constexpr float kStepUp = 1.1f;
+    static constexpr float kHeadroom = 0.7f;       // cost below this fraction of the target counts as spare
+    static constexpr float kDownAfterSeconds = 0.5f;
+    static constexpr float kUpAfterSeconds = 3.0f;  // slower to grow back than to shrink, so it doesn't flap
+    static constexpr float kSettleSeconds = 1.0f;   // after a change, let the new load show up first
+
+    void Load(const string& settingsPath); // <target_frame_ms> and <min_load_scale> from the settings file
+    void SetTargetMillis(float millis) { m_targetMillis = millis; } // 0 turns the governor off
+    void SetMinScale(float scale) { m_minScale = std::clamp(scale, 0.05f, 1.0f); }
+
+    // once per frame with what the frame's work cost, returns true when the scale changed
+    bool AddFrame(float costMillis, float frameSeconds);
+    float GetScale() const { return m_scale; }
+    string Report() const;
+
+private:
+    float m_targetMillis = 0.0f;
+    float m_minScale = 0.25f;
+    float m_scale = 1.0f;
+    float m_averageMillis = 0.0f; // smoothed over a few frames so one hitch doesn't count as a trend
+    float m_overSeconds = 0.0f;
+    float m_underSeconds = 0.0f;
+    float m_settleSeconds = 0.0f;
+    int m_changes = 0;
+};
@@ -0,0 +1,179 @@
+#include "MemoryTracker.h"
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include "ofMain.h"
+
+namespace {
+    // constant initialized, safe to touch from operator new
+    thread_local uint64_t t_heapAllocations = 0;
+    thread_local uint64_t t_trackedAllocations = 0;
+    constexpr size_t kTagCount = static_cast<size_t>(MemoryTag::COUNT);
+
+    struct TagCounters {
+        std::atomic<int64_t> liveBytes{0};
+        std::atomic<int64_t> liveCount{0};
+        std::atomic<int64_t> peakBytes{0};
+        std::atomic<size_t> budgetBytes{0};
+        std::atomic<bool> overBudget{false};
+    };
+
+    std::array<TagCounters, kTagCount>& Counters() {
+        static std::array<TagCounters, kTagCount> counters;
+        return counters;
+    }
+}
+
+std::string MemoryTagToString(MemoryTag tag) {
+    switch (tag) {
+        case MemoryTag::SPRITES: return "sprites";
+        case MemoryTag::CREATURES: return "creatures";
+        case MemoryTag::LEVELS: return "levels";
+        case MemoryTag::EVENTS: return "events";
+        case MemoryTag::PROJECTILES: return "projectiles";
+        case MemoryTag::AUDIO: return "audio";
+        case MemoryTag::PARTICLES: return "particles";
+        case MemoryTag::CAPTURE: return "capture";
+        default: return "unknown";
+    }
+}
+
+void MemoryTracker::Allocated(MemoryTag tag, size_t bytes) {
+    if (tag == MemoryTag::COUNT) return;
+    TagCounters& counters = Counters()[static_cast<size_t>(tag)];
+    int64_t live = counters.liveBytes.fetch_add(int64_t(bytes), std::memory_order_relaxed) + int64_t(bytes);
+    counters.liveCount.fetch_add(1, std::memory_order_relaxed);
+    int64_t peak = counters.peakBytes.load(std::memory_order_relaxed);
+    while (live > peak && !counters.peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+void MemoryTracker::Freed(MemoryTag tag, size_t bytes) {
+    if (tag == MemoryTag::COUNT) return;
+    TagCounters& counters = Counters()[static_cast<size_t>(tag)];
+    counters.liveBytes.fetch_sub(int64_t(bytes), std::memory_order_relaxed);
+    counters.liveCount.fetch_sub(1, std::memory_order_relaxed);
+}
+
+MemoryTagStats MemoryTracker::GetStats(MemoryTag tag) {
+    const TagCounters& counters = Counters()[static_cast<size_t>(tag)];
+    MemoryTagStats stats;
+    stats.liveBytes = counters.liveBytes.load(std::memory_order_relaxed);
+    stats.liveCount = counters.liveCount.load(std::memory_order_relaxed);
+    stats.peakBytes = counters.peakBytes.load(std::memory_order_relaxed);
+    stats.budgetBytes = counters.budgetBytes.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void MemoryTracker::SetBudget(MemoryTag tag, size_t bytes) {
+    Counters()[static_cast<size_t>(tag)].budgetBytes = bytes;
+}
+
+void MemoryTracker::LoadBudgets(const std::string& settingsPath) {
+    ofXml settings;
+    if (!settings.load(settingsPath)) return;
+    auto budgets = settings.getChild("group").getChild("memory_budget_kb");
+    if (!budgets) return;
+    for (size_t i = 0; i < kTagCount; ++i) {
+        MemoryTag tag = static_cast<MemoryTag>(i);
+        if (auto budget = budgets.getChild(MemoryTagToString(tag))) {
+            SetBudget(tag, size_t(std::max(0, budget.getIntValue())) * 1024);
+        }
+    }
+}
+
+void MemoryTracker::CheckBudgets() {
+    for (size_t i = 0; i < kTagCount; ++i) {
+        MemoryTag tag = static_cast<MemoryTag>(i);
+        TagCounters& counters = Counters()[i];
+        size_t budget = counters.budgetBytes.load();
+        if (budget == 0) continue;
+        bool over = counters.liveBytes.load() > int64_t(budget);
+        // warn on the way over, stay quiet until it drops back under
+        if (over && !counters.overBudget.exchange(true)) {
+            ofLogWarning("MemoryTracker") << MemoryTagToString(tag) << " over budget: "
+                << counters.liveBytes.load() / 1024 << " KB live, budget " << budget / 1024 << " KB";
+        } else if (!over) {
+            counters.overBudget = false;
+        }
+    }
+}
+
+std::string MemoryTracker::Report() {
+    std::ostringstream out;
+    for (size_t i = 0; i < kTagCount; ++i) {
+        MemoryTag tag = static_cast<MemoryTag>(i);
+        MemoryTagStats stats = GetStats(tag);
+        out << MemoryTagToString(tag) << ": " << stats.liveBytes / 1024 << " KB in " << stats.liveCount
+            << " (peak " << stats.peakBytes / 1024 << " KB";
+        if (stats.budgetBytes > 0) {
+            out << ", budget " << stats.budgetBytes / 1024 << " KB";
+        }
+        out << ")\n";
+    }
+    return out.str();
+}
+
+bool MemoryTracker::AppendReport(const std::string& path) {
+    std::ofstream out(path, std::ios::app);
+    if (!out) return false;
+    out << "[" << ofGetTimestampString() << "]\n" << Report();
+    return true;
+}
+
+
+void MemoryCharge::Set(MemoryTag tag, size_t bytes) {
+    if (m_bytes > 0) {
+        MemoryTracker::Freed(m_tag, m_bytes);
+    }
+    m_tag = tag;
+    m_bytes = bytes;
+    if (m_bytes > 0) {
+        MemoryTracker::Allocated(m_tag, m_bytes);
+    }
+}
+
+void* MemoryTracker::AllocateTracked(MemoryTag tag, size_t bytes) {
+    Allocated(tag, bytes);
+    ++t_trackedAllocations;
+    return ::operator new(bytes);
+}
+
+void MemoryTracker::FreeTracked(MemoryTag tag, void* memory, size_t bytes) {
+    Freed(tag, bytes);
+    ::operator delete(memory);
+}
+
+uint64_t MemoryTracker::GetThreadHeapAllocations() {
+    return t_heapAllocations;
+}
+
+uint64_t MemoryTracker::GetThreadUntrackedHeapAllocations() {
+    return t_heapAllocations - t_trackedAllocations;
+}
+
+// counting replacements, the array and nothrow forms end up in these. Sized delete is spelled out as well,
+// a sanitizer runtime would otherwise hand it to its own allocator.
+void* operator new(std::size_t bytes) {
+    ++t_heapAllocations;
+    while (true) {
+        if (void* memory = std::malloc(bytes > 0 ? bytes : 1)) {
+            return memory;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
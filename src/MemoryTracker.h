@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Subsystems we account memory to
+enum class MemoryTag {
+    SPRITES,     // decoded image pixels and their textures
+    CREATURES,
+    LEVELS,
+    EVENTS,
+    PROJECTILES,
+    AUDIO,
+    PARTICLES,
+    CAPTURE,     // frame readback buffers, only while recording
+    COUNT
+};
+
+std::string MemoryTagToString(MemoryTag tag);
+
+struct MemoryTagStats {
+    int64_t liveBytes = 0;
+    int64_t liveCount = 0;
+    int64_t peakBytes = 0;
+    size_t budgetBytes = 0; // 0 means no budget
+};
+
+// Process-wide live bytes and counts per tag. The counters are atomics, headless tanks on worker threads
+// report into the same totals.
+class MemoryTracker {
+public:
+    static void Allocated(MemoryTag tag, size_t bytes);
+    static void Freed(MemoryTag tag, size_t bytes);
+    static MemoryTagStats GetStats(MemoryTag tag);
+
+    static void SetBudget(MemoryTag tag, size_t bytes);
+    static void LoadBudgets(const std::string& settingsPath); // <memory_budget_kb> in the settings file
+    static void CheckBudgets(); // logs a warning when a tag goes over its budget, once per crossing
+
+    static std::string Report(); // one line per tag
+    static bool AppendReport(const std::string& path);
+
+    // for TrackedAllocator, accounts the block and counts it as a tracked heap allocation of this thread
+    static void* AllocateTracked(MemoryTag tag, size_t bytes);
+    static void FreeTracked(MemoryTag tag, void* memory, size_t bytes);
+
+    // general heap allocations (global operator new) made so far by the calling thread. The untracked ones
+    // didn't come through TrackedAllocator: scratch lists, strings, log buffers, what a steady tick shouldn't
+    // make at all (see FrameArena). Spawned creatures, boss shots and game events are MakeTracked, so they
+    // still hit operator new but only show in the total.
+    static uint64_t GetThreadHeapAllocations();
+    static uint64_t GetThreadUntrackedHeapAllocations();
+};
+
+// Allocator that accounts every block to a tag, used through MakeTracked so the shared_ptr control block
+// is counted along with the object
+template <typename T>
+struct TrackedAllocator {
+    using value_type = T;
+    MemoryTag tag;
+
+    explicit TrackedAllocator(MemoryTag t) : tag(t) {}
+    template <typename U>
+    TrackedAllocator(const TrackedAllocator<U>& other) : tag(other.tag) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(MemoryTracker::AllocateTracked(tag, n * sizeof(T))); }
+    void deallocate(T* p, size_t n) { MemoryTracker::FreeTracked(tag, p, n * sizeof(T)); }
+    template <typename U>
+    bool operator==(const TrackedAllocator<U>& other) const { return tag == other.tag; }
+    template <typename U>
+    bool operator!=(const TrackedAllocator<U>& other) const { return tag != other.tag; }
+};
+
+template <typename T, typename... Args>
+std::shared_ptr<T> MakeTracked(MemoryTag tag, Args&&... args) {
+    return std::allocate_shared<T>(TrackedAllocator<T>(tag), std::forward<Args>(args)...);
+}
+
+// Charges a number of bytes to a tag for as long as it lives, for memory we don't allocate ourselves
+// (image pixels, textures, sound files). Copies charge again, like the data they stand for.
+class MemoryCharge {
+public:
+    MemoryCharge() = default;
+    MemoryCharge(MemoryTag tag, size_t bytes) { Set(tag, bytes); }
+    MemoryCharge(const MemoryCharge& other) { Set(other.m_tag, other.m_bytes); }
+    MemoryCharge& operator=(const MemoryCharge& other) {
+        if (this != &other) Set(other.m_tag, other.m_bytes);
+        return *this;
+    }
+    ~MemoryCharge() { Set(m_tag, 0); }
+    void Set(MemoryTag tag, size_t bytes);
+
+private:
+    MemoryTag m_tag = MemoryTag::COUNT;
+    size_t m_bytes = 0;
+};
@@ -0,0 +1,144 @@
+#include "ParticleSystem.h"
+
+namespace {
+    struct ParticleLook {
+        ofFloatColor color;
+        float gravity; // px/s^2, negative rises
+        float drag;    // fraction of the velocity kept per second
+        float pointSize;
+    };
+
+    const ParticleLook& LookOf(size_t material) {
+        static const std::array<ParticleLook, static_cast<size_t>(ParticleMaterial::COUNT)> looks = {{
+            {ofFloatColor(0.8f, 0.9f, 1.0f, 0.6f), -60.0f, 0.6f, 4.0f}, // BUBBLE
+            {ofFloatColor(1.0f, 0.85f, 0.3f, 1.0f), 0.0f, 0.1f, 3.0f},  // SPARK
+            {ofFloatColor(1.0f, 0.2f, 0.2f, 1.0f), 120.0f, 0.2f, 5.0f}, // IMPACT
+        }};
+        return looks[material];
+    }
+}
+
+void ParticleSystem::Load(const string& settingsPath) {
+    size_t budget = 20000;
+    ofXml settings;
+    if (settings.load(settingsPath)) {
+        if (auto node = settings.getChild("group").getChild("particle_budget")) {
+            budget = size_t(std::max(0, node.getIntValue()));
+        }
+    }
+    this->SetBudget(budget);
+}
+
+void ParticleSystem::SetBudget(size_t budget) {
+    m_budget = budget;
+    m_activeBudget = budget;
+    for (auto* values : {&m_x, &m_y, &m_vx, &m_vy, &m_age, &m_life}) {
+        values->resize(budget);
+    }
+    m_material.resize(budget);
+    m_count = std::min(m_count, budget);
+    m_memory.Set(MemoryTag::PARTICLES, budget * (6 * sizeof(float) + sizeof(uint8_t)));
+}
+
+int ParticleSystem::Emit(ParticleMaterial material, float x, float y, int count, float speed, float lifeSeconds) {
+    if (count <= 0) return 0;
+    int allowed = count;
+    float fill = m_activeBudget > 0 ? float(m_count) / m_activeBudget : 1.0f;
+    if (fill > kDegradeFrom) {
+        allowed = int(count * std::max(0.0f, 1.0f - fill) / (1.0f - kDegradeFrom));
+    }
+    allowed = std::min<int>(allowed, int(m_activeBudget) - int(std::min(m_count, m_activeBudget)));
+    m_dropped += count - allowed;
+
+    std::uniform_real_distribution<float> angle(0.0f, TWO_PI);
+    std::uniform_real_distribution<float> spread(0.3f, 1.0f);
+    for (int i = 0; i < allowed; ++i) {
+        size_t p = m_count++;
+        float a = angle(m_rng);
+        float s = speed * spread(m_rng);
+        m_x[p] = x;
+        m_y[p] = y;
+        m_vx[p] = std::cos(a) * s;
+        m_vy[p] = std::sin(a) * s;
+        m_age[p] = 0.0f;
+        m_life[p] = lifeSeconds * spread(m_rng);
+        m_material[p] = uint8_t(material);
+    }
+    m_emitted += allowed;
+    return allowed;
+}
+
+void ParticleSystem::Update(float dt) {
+    if (m_count == 0) return;
+    std::array<float, static_cast<size_t>(ParticleMaterial::COUNT)> gravity;
+    std::array<float, static_cast<size_t>(ParticleMaterial::COUNT)> drag;
+    for (size_t m = 0; m < gravity.size(); ++m) {
+        gravity[m] = LookOf(m).gravity * dt;
+        drag[m] = std::pow(LookOf(m).drag, dt);
+    }
+
+    // one pass over the packed arrays, then drop the dead by moving the last live particle into their slot
+    for (size_t p = 0; p < m_count; ++p) {
+        uint8_t material = m_material[p];
+        m_vx[p] *= drag[material];
+        m_vy[p] = m_vy[p] * drag[material] + gravity[material];
+        m_x[p] += m_vx[p] * dt;
+        m_y[p] += m_vy[p] * dt;
+        m_age[p] += dt;
+    }
+    for (size_t p = 0; p < m_count;) {
+        if (m_age[p] < m_life[p]) {
+            ++p;
+            continue;
+        }
+        size_t last = --m_count;
+        m_x[p] = m_x[last];
+        m_y[p] = m_y[last];
+        m_vx[p] = m_vx[last];
+        m_vy[p] = m_vy[last];
+        m_age[p] = m_age[last];
+        m_life[p] = m_life[last];
+        m_material[p] = m_material[last];
+    }
+}
+
+void ParticleSystem::Draw() const {
+    if (m_count == 0) return;
+    std::array<size_t, static_cast<size_t>(ParticleMaterial::COUNT)> counts{};
+    for (size_t p = 0; p < m_count; ++p) {
+        ++counts[m_material[p]];
+    }
+    for (size_t m = 0; m < m_meshes.size(); ++m) {
+        ofVboMesh& mesh = m_meshes[m];
+        mesh.setMode(OF_PRIMITIVE_POINTS);
+        mesh.setUsage(GL_STREAM_DRAW);
+        mesh.getVertices().resize(counts[m]);
+        mesh.getColors().resize(counts[m]);
+        counts[m] = 0; // reused as the write cursor
+    }
+    for (size_t p = 0; p < m_count; ++p) {
+        uint8_t material = m_material[p];
+        ofVboMesh& mesh = m_meshes[material];
+        size_t i = counts[material]++;
+        ofFloatColor color = LookOf(material).color;
+        color.a *= 1.0f - m_age[p] / m_life[p]; // fade out over the lifetime
+        mesh.getVertices()[i] = glm::vec3(m_x[p], m_y[p], 0.0f);
+        mesh.getColors()[i] = color;
+    }
+
+    ofPushStyle();
+    ofEnableAlphaBlending();
+    for (size_t m = 0; m < m_meshes.size(); ++m) {
+        if (counts[m] == 0) continue;
+        glPointSize(LookOf(m).pointSize);
+        m_meshes[m].draw();
+    }
+    glPointSize(1.0f);
+    ofPopStyle();
+}
+
+string ParticleSystem::Report() const {
+    std::ostringstream out;
+    out << "particles " << m_count << "/" << m_activeBudget << " emitted " << m_emitted << " dropped " << m_dropped;
+    return out.str();
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "ofMain.h"
+#include "MemoryTracker.h"
+
+// each material is one batched draw
+enum class ParticleMaterial {
+    BUBBLE, // drifts up
+    SPARK,  // eat and power-up bursts
+    IMPACT, // the player getting hit
+    COUNT
+};
+
+// Particles in packed arrays (one per attribute), integrated in a single pass per tick and drawn as one point
+// mesh per material. The budget is hard: as the pool fills up bursts get thinner, and past the budget
+// nothing new is emitted, so a busy moment costs detail instead of frame time.
+class ParticleSystem {
+public:
+    static constexpr float kDegradeFrom = 0.75f; // fraction of the budget where bursts start thinning out
+
+    void Load(const string& settingsPath); // <particle_budget> from the settings file
+    void SetBudget(size_t budget); // reserves the whole budget up front, emitting never allocates
+    size_t GetBudget() const { return m_budget; }
+    void SetLoadScale(float scale) { m_activeBudget = size_t(m_budget * std::clamp(scale, 0.0f, 1.0f)); } // see LoadGovernor
+
+    // returns how many particles were actually emitted
+    int Emit(ParticleMaterial material, float x, float y, int count, float speed, float lifeSeconds);
+    void Update(float dt);
+    void Draw() const;
+    void Clear() { m_count = 0; }
+
+    size_t GetLiveCount() const { return m_count; }
+    string Report() const;
+
+private:
+    std::vector<float> m_x;
+    std::vector<float> m_y;
+    std::vector<float> m_vx;
+    std::vector<float> m_vy;
+    std::vector<float> m_age;
+    std::vector<float> m_life;
+    std::vector<uint8_t> m_material;
+    size_t m_count = 0; // live particles are [0, m_count)
+    size_t m_budget = 0;
+    size_t m_activeBudget = 0; // the part of the budget the load scale allows, the pool keeps its full size
+    uint64_t m_emitted = 0;
+    uint64_t m_dropped = 0;
+    std::minstd_rand m_rng;
+    MemoryCharge m_memory;
+
+    mutable std::array<ofVboMesh, static_cast<size_t>(ParticleMaterial::COUNT)> m_meshes;
+};
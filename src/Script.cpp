@@ -0,0 +1,122 @@
+#include "Script.h"
+#include <cmath>
+#include <exception>
+#include "Core.h"
+
+
+void Script::promise_type::unhandled_exception() {
+    // gameplay code doesn't throw on purpose, the script just ends here
+    try {
+        throw;
+    } catch (const std::exception& e) {
+        ofLogError("Script") << "script " << id << " ended on an exception: " << e.what();
+    } catch (...) {
+        ofLogError("Script") << "script " << id << " ended on an exception";
+    }
+}
+
+void ScriptRunner::StepWait::await_suspend(Script::Handle script) {
+    uint64_t id = script.promise().id;
+    runner->m_scripts.at(id).timer = runner->m_timers.Schedule(steps, 0, id);
+}
+
+void ScriptRunner::ConditionWait::await_suspend(Script::Handle script) {
+    runner->m_waiting.push_back({script.promise().id, std::move(condition)});
+}
+
+ScriptRunner::ScriptRunner() {
+    m_timers.SetHandler(0, [this](TimerHandle, uint64_t id) {
+        auto it = m_scripts.find(id);
+        if (it != m_scripts.end()) {
+            it->second.timer = TimerHandle{};
+            this->resume(id);
+        }
+    });
+}
+
+ScriptRunner::~ScriptRunner() {
+    for (auto& [id, entry] : m_scripts) {
+        entry.handle.destroy();
+    }
+}
+
+ScriptId ScriptRunner::Start(Script script) {
+    ScriptId id = m_nextId++;
+    Script::Handle handle = std::exchange(script.m_handle, {});
+    handle.promise().id = id;
+    m_scripts.emplace(id, Entry{handle});
+    this->resume(id);
+    return this->IsRunning(id) ? id : 0;
+}
+
+void ScriptRunner::resume(ScriptId id) {
+    Entry& entry = m_scripts.at(id);
+    entry.resuming = true;
+    entry.handle.resume();
+    entry.resuming = false;
+    ++m_resumes;
+    if (entry.handle.done() || entry.stopped) {
+        m_timers.Cancel(entry.timer);
+        entry.handle.destroy();
+        m_scripts.erase(id);
+    }
+}
+
+void ScriptRunner::Stop(ScriptId id) {
+    auto it = m_scripts.find(id);
+    if (it == m_scripts.end()) return;
+    Entry& entry = it->second;
+    if (entry.resuming) {
+        entry.stopped = true; // can't destroy a frame that is on the stack, resume() does it when it returns
+        return;
+    }
+    m_timers.Cancel(entry.timer);
+    entry.handle.destroy();
+    m_scripts.erase(it);
+    // a condition wait it left behind is skipped and dropped by the next Advance
+}
+
+void ScriptRunner::StopAll() {
+    std::vector<ScriptId> ids;
+    ids.reserve(m_scripts.size());
+    for (const auto& [id, entry] : m_scripts) {
+        ids.push_back(id);
+    }
+    for (ScriptId id : ids) {
+        this->Stop(id);
+    }
+}
+
+ScriptRunner::StepWait ScriptRunner::Wait(float seconds) {
+    return StepWait{this, uint64_t(std::max(0L, std::lround(seconds / kFixedTickSeconds)))};
+}
+
+void ScriptRunner::Advance() {
+    m_timers.Advance();
+    if (!m_conditionsDirty) return;
+    m_conditionsDirty = false;
+    // scripts resumed here may start new waits, those land in m_waiting and go after the ones still waiting.
+    // The two lists trade places instead of being rebuilt, so an eaten fish doesn't cost a heap allocation.
+    std::swap(m_waiting, m_checking);
+    m_waiting.clear();
+    size_t kept = 0;
+    for (Waiting& wait : m_checking) {
+        if (!this->IsRunning(wait.id)) continue;
+        if (wait.condition()) {
+            this->resume(wait.id);
+        } else {
+            m_checking[kept++] = std::move(wait);
+        }
+    }
+    m_checking.erase(m_checking.begin() + kept, m_checking.end());
+    m_checking.insert(m_checking.end(), std::make_move_iterator(m_waiting.begin()), std::make_move_iterator(m_waiting.end()));
+    std::swap(m_waiting, m_checking);
+    m_checking.clear();
+}
+
+string ScriptRunner::Report() const {
+    std::ostringstream out;
+    out << "scripts " << m_scripts.size() << " on timers " << m_timers.GetPendingCount()
+        << " on conditions " << m_waiting.size() << " resumes " << m_resumes;
+    return out.str();
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <coroutine>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "ofMain.h"
+#include "TimerWheel.h"
+
+// A gameplay script, a C++20 coroutine that co_awaits its runner's waits in between straight-line steps:
+//
+//     Script BossAttacks(ScriptRunner& sim, ...) {
+//         while (...) {
+//             co_await sim.Wait(2.0f);
+//             ...
+//         }
+//     }
+//
+// The script function only builds it, nothing runs until it is handed to ScriptRunner::Start.
+class Script {
+public:
+    struct promise_type {
+        uint64_t id = 0; // set by the runner
+        Script get_return_object() { return Script(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; } // the runner destroys it once it sees it done
+        void return_void() {}
+        void unhandled_exception();
+    };
+    using Handle = std::coroutine_handle<promise_type>;
+
+    Script(Script&& other) noexcept : m_handle(std::exchange(other.m_handle, {})) {}
+    Script(const Script&) = delete;
+    Script& operator=(const Script&) = delete;
+    ~Script() { if (m_handle) m_handle.destroy(); }
+
+private:
+    friend class ScriptRunner;
+    explicit Script(Handle handle) : m_handle(handle) {}
+    Handle m_handle;
+};
+
+using ScriptId = uint64_t; // 0 is never a running script
+
+// Owns and resumes scripts, once per simulation step from Advance(). A script waiting on time sits in a
+// TimerWheel and a script waiting on a condition is only looked at after someone called Notify(), so idle
+// scripts cost nothing per step. Everything runs on the thread that calls Advance().
+class ScriptRunner {
+public:
+    struct StepWait {
+        ScriptRunner* runner;
+        uint64_t steps;
+        bool await_ready() const noexcept { return steps == 0; }
+        void await_suspend(Script::Handle script);
+        void await_resume() const noexcept {}
+    };
+    struct ConditionWait {
+        ScriptRunner* runner;
+        std::function<bool()> condition;
+        bool await_ready() const { return condition(); }
+        void await_suspend(Script::Handle script);
+        void await_resume() const noexcept {}
+    };
+
+    ScriptRunner();
+    ~ScriptRunner();
+    ScriptRunner(const ScriptRunner&) = delete;
+    ScriptRunner& operator=(const ScriptRunner&) = delete;
+
+    ScriptId Start(Script script); // runs it up to its first wait, 0 when it finished right away
+    void Stop(ScriptId id); // a script may stop itself, it then ends at its next wait
+    void StopAll();
+    bool IsRunning(ScriptId id) const { return m_scripts.count(id) > 0; }
+
+    // only for co_await inside a script running on this runner
+    StepWait Wait(float seconds); // in steps of kFixedTickSeconds
+    StepWait WaitSteps(uint64_t steps) { return StepWait{this, steps}; }
+    // checked right away and then after each Notify(). Name a capturing lambda before passing it here, GCC 12
+    // destroys a closure temporary inside a co_await expression twice.
+    ConditionWait WaitUntil(std::function<bool()> condition) { return ConditionWait{this, std::move(condition)}; }
+
+    void Notify() { m_conditionsDirty = true; } // something a condition reads changed, checked at the next Advance
+    void Advance(); // one step: due timed waits, then conditions if notified
+
+    size_t GetCount() const { return m_scripts.size(); }
+    string Report() const;
+
+private:
+    struct Entry {
+        Script::Handle handle{};
+        TimerHandle timer{};
+        bool resuming = false;
+        bool stopped = false;
+    };
+    struct Waiting {
+        ScriptId id;
+        std::function<bool()> condition;
+    };
+
+    void resume(ScriptId id);
+
+    std::unordered_map<ScriptId, Entry> m_scripts; // entries don't move on rehash, resume() relies on that
+    ScriptId m_nextId = 1;
+    TimerWheel m_timers; // one tick per step
+    std::vector<Waiting> m_waiting;
+    std::vector<Waiting> m_checking; // Advance()'s other list, kept for its capacity
+    bool m_conditionsDirty = false;
+    uint64_t m_resumes = 0;
+};
@@ -0,0 +1,50 @@
+#include "SelfTest.h"
+#include <algorithm>
+#include <iostream>
+#include "ofMain.h"
+
+namespace {
+    struct SelfTestCase {
+        string name;
+        void (*run)();
+    };
+
+    // filled by static initializers, so it has to exist before the first of them runs
+    std::vector<SelfTestCase>& Registry() {
+        static std::vector<SelfTestCase> tests;
+        return tests;
+    }
+
+    int g_failedChecks = 0; // in the test that is running
+}
+
+bool RegisterSelfTest(const char* name, void (*run)()) {
+    Registry().push_back({name, run});
+    return true;
+}
+
+void SelfTestCheck(bool passed, const char* expression, const char* file, int line) {
+    if (passed) return;
+    ++g_failedChecks;
+    std::cerr << file << ":" << line << ": check failed: " << expression << std::endl;
+}
+
+int RunSelfTests(const std::vector<std::string>& args) {
+    string prefix = args.empty() ? "" : args[0];
+    ofSetLogLevel(OF_LOG_WARNING);
+
+    std::vector<SelfTestCase> tests = Registry();
+    std::sort(tests.begin(), tests.end(), [](const SelfTestCase& a, const SelfTestCase& b) { return a.name < b.name; });
+    int ran = 0;
+    int failed = 0;
+    for (const SelfTestCase& test : tests) {
+        if (test.name.compare(0, prefix.size(), prefix) != 0) continue;
+        g_failedChecks = 0;
+        test.run();
+        ++ran;
+        failed += g_failedChecks > 0;
+        std::cout << (g_failedChecks > 0 ? "FAIL " : "ok   ") << test.name << std::endl;
+    }
+    std::cout << ran - failed << " of " << ran << " self tests passed" << std::endl;
+    return ran > 0 && failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Checks for the engine pieces that are easy to get subtly wrong and hard to see in play (the timer wheel,
+// collision masks and sweeps, the sim to render handoff). The tests live in src/tests, one file per subsystem,
+// and run headless:
+//
+//   Aquarium --self-test [NAME_PREFIX]
+//
+// Exit codes: 0 every test that ran passed, 1 a check failed or no test matched.
+int RunSelfTests(const std::vector<std::string>& args);
+
+bool RegisterSelfTest(const char* name, void (*run)());
+void SelfTestCheck(bool passed, const char* expression, const char* file, int line);
+
+// SELF_TEST(TimerWheelCancel) { ... SELF_CHECK(a == b); ... }
+#define SELF_TEST(name) \
+    static void name(); \
+    static const bool name##Registered = RegisterSelfTest(#name, name); \
+    static void name()
+#define SELF_CHECK(expression) SelfTestCheck(bool(expression), #expression, __FILE__, __LINE__)
@@ -0,0 +1,221 @@
+#include "SfxMixer.h"
+#include <cstring>
+
+namespace {
+    std::atomic<SfxMixer*> s_activeMixer{nullptr};
+
+    uint32_t readLE32(const unsigned char* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | (uint32_t(p[3]) << 24); }
+    uint16_t readLE16(const unsigned char* p) { return uint16_t(p[0] | (p[1] << 8)); }
+}
+
+string SfxIdToString(SfxId id) {
+    switch (id) {
+        case SfxId::EAT: return "eat";
+        case SfxId::DAMAGE: return "damage";
+        case SfxId::POWER_UP: return "power_up";
+        case SfxId::BOSS_ATTACK: return "boss_attack";
+        default: return "unknown";
+    }
+}
+
+void PlaySfx(SfxId id, float gain, float pan) {
+    if (SfxMixer* mixer = s_activeMixer.load(std::memory_order_acquire)) {
+        mixer->Trigger(id, gain, pan);
+    }
+}
+
+
+SfxMixer::~SfxMixer() {
+    this->Close();
+}
+
+void SfxMixer::Setup() {
+    for (size_t i = 0; i < m_samples.size(); ++i) {
+        SfxId id = static_cast<SfxId>(i);
+        Sample& sample = m_samples[i];
+        string path = "sfx/" + SfxIdToString(id) + ".wav";
+        if (!loadWav(ofToDataPath(path), sample.frames)) {
+            ofLogNotice("SfxMixer") << path << " not found, using a synthesized " << SfxIdToString(id);
+            synthesize(id, sample.frames);
+        }
+        sample.memory.Set(MemoryTag::AUDIO, sample.frames.size() * sizeof(float));
+    }
+
+    ofSoundStreamSettings settings;
+    settings.setOutListener(this);
+    settings.sampleRate = kSampleRate;
+    settings.numOutputChannels = 2;
+    settings.numInputChannels = 0;
+    settings.bufferSize = kBufferSize;
+    if (!m_stream.setup(settings)) {
+        ofLogWarning("SfxMixer") << "could not open the audio output, sound effects are off";
+        return;
+    }
+    s_activeMixer = this;
+}
+
+void SfxMixer::Close() {
+    SfxMixer* self = this;
+    s_activeMixer.compare_exchange_strong(self, nullptr);
+    m_stream.close();
+}
+
+bool SfxMixer::Trigger(SfxId id, float gain, float pan) {
+    size_t tail = m_queueTail.load(std::memory_order_relaxed);
+    if (tail - m_queueHead.load(std::memory_order_acquire) >= kQueueSize) {
+        ++m_dropped;
+        return false;
+    }
+    m_queue[tail & (kQueueSize - 1)] = {id, gain, std::clamp(pan, -1.0f, 1.0f)};
+    m_queueTail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+void SfxMixer::startVoice(const Command& command) {
+    const Sample& sample = m_samples[static_cast<size_t>(command.id)];
+    if (sample.frames.empty()) return;
+    Voice* voice = nullptr;
+    for (Voice& candidate : m_voices) {
+        if (!candidate.sample) {
+            voice = &candidate;
+            break;
+        }
+        if (!voice || candidate.order < voice->order) {
+            voice = &candidate; // oldest so far, stolen if nothing is free
+        }
+    }
+    if (voice->sample) ++m_stolen;
+    voice->sample = &sample;
+    voice->position = 0;
+    voice->left = command.gain * std::min(1.0f, 1.0f - command.pan);
+    voice->right = command.gain * std::min(1.0f, 1.0f + command.pan);
+    voice->order = ++m_voiceOrder;
+    ++m_played;
+}
+
+void SfxMixer::audioOut(ofSoundBuffer& buffer) {
+    size_t tail = m_queueTail.load(std::memory_order_acquire);
+    size_t head = m_queueHead.load(std::memory_order_relaxed);
+    for (; head != tail; ++head) {
+        this->startVoice(m_queue[head & (kQueueSize - 1)]);
+    }
+    m_queueHead.store(head, std::memory_order_release);
+
+    buffer.set(0.0f);
+    size_t frames = buffer.getNumFrames();
+    size_t channels = buffer.getNumChannels();
+    float volume = m_volume.load(std::memory_order_relaxed);
+    float* out = buffer.getBuffer().data();
+    for (Voice& voice : m_voices) {
+        if (!voice.sample) continue;
+        const std::vector<float>& samples = voice.sample->frames;
+        size_t count = std::min(frames, samples.size() - voice.position);
+        for (size_t i = 0; i < count; ++i) {
+            float s = samples[voice.position + i] * volume;
+            out[i * channels] += s * voice.left;
+            if (channels > 1) out[i * channels + 1] += s * voice.right;
+        }
+        voice.position += count;
+        if (voice.position >= samples.size()) {
+            voice.sample = nullptr;
+        }
+    }
+    for (size_t i = 0; i < frames * channels; ++i) {
+        out[i] = std::clamp(out[i], -1.0f, 1.0f);
+    }
+}
+
+string SfxMixer::Report() const {
+    std::ostringstream out;
+    out << "sfx played " << m_played.load() << " stolen " << m_stolen.load() << " dropped " << m_dropped.load();
+    return out.str();
+}
+
+bool SfxMixer::loadWav(const string& path, std::vector<float>& frames) {
+    if (!ofFile::doesFileExist(path, false)) return false;
+    ofBuffer file = ofBufferFromFile(path, true);
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(file.getData());
+    size_t size = file.size();
+    if (size < 12 || std::memcmp(data, "RIFF", 4) != 0 || std::memcmp(data + 8, "WAVE", 4) != 0) {
+        ofLogWarning("SfxMixer") << path << " is not a WAV file";
+        return false;
+    }
+
+    // 16 bit PCM only, mixed down to mono and resampled to the mixer rate
+    uint16_t format = 0, channels = 0, bits = 0;
+    uint32_t rate = 0;
+    const unsigned char* pcm = nullptr;
+    size_t pcmBytes = 0;
+    for (size_t offset = 12; offset + 8 <= size;) {
+        uint32_t chunkSize = readLE32(data + offset + 4);
+        const unsigned char* chunk = data + offset + 8;
+        size_t available = std::min<size_t>(chunkSize, size - offset - 8);
+        if (std::memcmp(data + offset, "fmt ", 4) == 0 && available >= 16) {
+            format = readLE16(chunk);
+            channels = readLE16(chunk + 2);
+            rate = readLE32(chunk + 4);
+            bits = readLE16(chunk + 14);
+        } else if (std::memcmp(data + offset, "data", 4) == 0) {
+            pcm = chunk;
+            pcmBytes = available;
+        }
+        offset += 8 + chunkSize + (chunkSize & 1);
+    }
+    if (format != 1 || bits != 16 || channels == 0 || rate == 0 || !pcm) {
+        ofLogWarning("SfxMixer") << path << ": only 16 bit PCM WAV files are supported";
+        return false;
+    }
+
+    size_t sourceFrames = pcmBytes / (2 * channels);
+    std::vector<float> mono(sourceFrames);
+    for (size_t i = 0; i < sourceFrames; ++i) {
+        float sum = 0.0f;
+        for (uint16_t c = 0; c < channels; ++c) {
+            sum += int16_t(readLE16(pcm + (i * channels + c) * 2)) / 32768.0f;
+        }
+        mono[i] = sum / channels;
+    }
+    if (rate == uint32_t(kSampleRate) || sourceFrames < 2) {
+        frames = std::move(mono);
+        return true;
+    }
+    size_t targetFrames = size_t(double(sourceFrames) * kSampleRate / rate);
+    frames.resize(targetFrames);
+    for (size_t i = 0; i < targetFrames; ++i) {
+        double at = double(i) * rate / kSampleRate;
+        size_t index = std::min(size_t(at), sourceFrames - 2);
+        float t = float(at - index);
+        frames[i] = mono[index] * (1.0f - t) + mono[index + 1] * t;
+    }
+    return true;
+}
+
+void SfxMixer::synthesize(SfxId id, std::vector<float>& frames) {
+    // short placeholder effects so the game has sound before real assets land in data/sfx
+    float seconds = 0.1f;
+    float startHz = 440.0f, endHz = 440.0f;
+    bool noise = false;
+    switch (id) {
+        case SfxId::EAT: seconds = 0.08f; startHz = 400.0f; endHz = 900.0f; break;
+        case SfxId::DAMAGE: seconds = 0.25f; startHz = 300.0f; endHz = 80.0f; break;
+        case SfxId::POWER_UP: seconds = 0.3f; startHz = 500.0f; endHz = 1500.0f; break;
+        case SfxId::BOSS_ATTACK: seconds = 0.2f; noise = true; break;
+        default: break;
+    }
+    frames.resize(size_t(seconds * kSampleRate));
+    uint32_t seed = 22222;
+    double phase = 0.0;
+    for (size_t i = 0; i < frames.size(); ++i) {
+        float t = float(i) / frames.size();
+        float envelope = std::min(1.0f, t * 50.0f) * (1.0f - t); // quick attack, linear decay
+        float value;
+        if (noise) {
+            seed = seed * 1664525u + 1013904223u;
+            value = (seed >> 8) / float(1 << 24) * 2.0f - 1.0f;
+        } else {
+            phase += (startHz + (endHz - startHz) * t) / kSampleRate;
+            value = std::sin(float(TWO_PI * phase));
+        }
+        frames[i] = value * envelope * 0.5f;
+    }
+}
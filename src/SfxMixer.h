@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "ofMain.h"
+#include "MemoryTracker.h"
+
+enum class SfxId {
+    EAT,
+    DAMAGE,
+    POWER_UP,
+    BOSS_ATTACK,
+    COUNT
+};
+
+string SfxIdToString(SfxId id);
+
+// Queues an effect on the running mixer, does nothing when there is none (headless tanks).
+// Safe to call from gameplay code: it never allocates, locks or touches the disk.
+void PlaySfx(SfxId id, float gain = 1.0f, float pan = 0.0f);
+
+// pan for something at x in a world width wide, -1 on the left edge to 1 on the right
+inline float SfxPan(float x, float width) { return width > 0 ? std::clamp(x / width * 2.0f - 1.0f, -1.0f, 1.0f) : 0.0f; }
+
+// Sound effects mixed on the audio thread from samples decoded up front, with a fixed pool of voices.
+// When every voice is busy the oldest one is stolen. Triggers reach the audio thread through a
+// single-producer ring, so only one thread (the one running the simulation) should trigger.
+class SfxMixer : public ofBaseSoundOutput {
+public:
+    static constexpr int kSampleRate = 44100;
+    static constexpr int kBufferSize = 256;
+    static constexpr int kMaxVoices = 16;
+    static constexpr size_t kQueueSize = 64; // power of two
+
+    ~SfxMixer();
+    // loads sfx/<name>.wav for every effect (a synthesized one when the file is missing) and opens the output,
+    // all the decoding and I/O happens here
+    void Setup();
+    void Close();
+
+    bool Trigger(SfxId id, float gain, float pan); // false if the queue was full and the effect was dropped
+    void SetVolume(float volume) { m_volume = std::clamp(volume, 0.0f, 1.0f); }
+
+    void audioOut(ofSoundBuffer& buffer) override;
+    string Report() const;
+
+private:
+    struct Sample {
+        std::vector<float> frames; // mono at kSampleRate
+        MemoryCharge memory;
+    };
+    struct Command {
+        SfxId id;
+        float gain;
+        float pan;
+    };
+    struct Voice {
+        const Sample* sample = nullptr; // null when free
+        size_t position = 0;
+        float left = 0.0f;
+        float right = 0.0f;
+        uint64_t order = 0; // start order, the lowest is stolen first
+    };
+
+    static bool loadWav(const string& path, std::vector<float>& frames);
+    static void synthesize(SfxId id, std::vector<float>& frames);
+    void startVoice(const Command& command);
+
+    std::array<Sample, static_cast<size_t>(SfxId::COUNT)> m_samples;
+    std::array<Voice, kMaxVoices> m_voices; // audio thread only
+    uint64_t m_voiceOrder = 0;
+
+    std::array<Command, kQueueSize> m_queue;
+    std::atomic<size_t> m_queueHead{0}; // next command the audio thread reads
+    std::atomic<size_t> m_queueTail{0}; // next slot the triggering thread writes
+    std::atomic<float> m_volume{1.0f};
+    std::atomic<uint32_t> m_played{0};
+    std::atomic<uint32_t> m_dropped{0};
+    std::atomic<uint32_t> m_stolen{0};
+    ofSoundStream m_stream;
+};
@@ -0,0 +1,107 @@
+#include "SimThread.h"
+#include <chrono>
+#include "Core.h"
+
+
+void SimThread::Load(const string& settingsPath) {
+    ofXml settings;
+    if (!settings.load(settingsPath)) return;
+    if (auto threaded = settings.getChild("group").getChild("threaded_sim")) {
+        m_enabled = threaded.getBoolValue();
+    }
+}
+
+void SimThread::Start(Tick tick) {
+    this->Stop();
+    m_tick = std::move(tick);
+    InputEdge stale;
+    while (m_input.Pop(stale)) {} // edges meant for a previous run
+    ConsumedEdge consumed;
+    while (m_consumed.Pop(consumed)) {}
+    m_inputState.Reset();
+    m_hasDeferred = false;
+    m_tickEdgeCount = 0;
+    m_running.store(true, std::memory_order_release);
+    m_thread = std::thread([this]() { this->run(); });
+}
+
+void SimThread::Stop() {
+    m_running.store(false, std::memory_order_release);
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+bool SimThread::PushInput(const InputEdge& edge) {
+    return m_input.Push(edge);
+}
+
+bool SimThread::PopConsumed(InputEdge& edge, uint64_t& consumedMicros) {
+    ConsumedEdge consumed;
+    if (!m_consumed.Pop(consumed)) return false;
+    edge = consumed.edge;
+    consumedMicros = consumed.consumedMicros;
+    return true;
+}
+
+InputFrame SimThread::drainInput() {
+    // edges go in one at a time, a tap that came in between two ticks is held for one of them
+    uint64_t now = ofGetElapsedTimeMicros();
+    while (m_hasDeferred || m_input.Pop(m_deferred)) {
+        if (!m_inputState.Apply(m_deferred)) {
+            m_hasDeferred = true; // the next tick starts with it
+            break;
+        }
+        m_hasDeferred = false;
+        m_tickEdges[m_tickEdgeCount++] = {m_deferred, now};
+    }
+    return m_inputState.EndTick();
+}
+
+void SimThread::reportConsumed() {
+    for (size_t i = 0; i < m_tickEdgeCount; ++i) {
+        m_consumed.Push(m_tickEdges[i]);
+    }
+    m_tickEdgeCount = 0;
+}
+
+void SimThread::run() {
+    using Clock = std::chrono::steady_clock;
+    const auto tickLength = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(kFixedTickSeconds));
+    Clock::time_point next = Clock::now();
+    while (m_running.load(std::memory_order_acquire)) {
+        int ticks = 0;
+        while (Clock::now() >= next && ticks < kMaxTicksPerWake) {
+            Clock::time_point start = Clock::now();
+            bool keepGoing = m_tick(this->drainInput());
+            this->reportConsumed(); // after the tick, so the frame that presents an edge has drawn its tick
+            float millis = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+            m_lastTickMillis.store(millis, std::memory_order_relaxed);
+            if (millis > m_maxTickMillis.load(std::memory_order_relaxed)) {
+                m_maxTickMillis.store(millis, std::memory_order_relaxed);
+            }
+            m_ticks.fetch_add(1, std::memory_order_relaxed);
+            next += tickLength;
+            ++ticks;
+            if (!keepGoing) {
+                m_running.store(false, std::memory_order_release);
+                return;
+            }
+        }
+        if (ticks == kMaxTicksPerWake) {
+            next = Clock::now(); // we fell too far behind, don't try to catch up
+            m_droppedWakes.fetch_add(1, std::memory_order_relaxed);
+        }
+        std::this_thread::sleep_until(next);
+    }
+}
+
+string SimThread::Report() const {
+    std::ostringstream out;
+    out.setf(std::ios::fixed);
+    out.precision(2);
+    out << "sim thread " << (m_enabled ? "on" : "off") << " ticks " << m_ticks.load()
+        << " tick ms last " << m_lastTickMillis.load() << " max " << m_maxTickMillis.load()
+        << " fell behind " << m_droppedWakes.load();
+    return out.str();
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include "ofMain.h"
+#include "InputSampler.h"
+
+// Latest-value handoff between one writer and one reader without locks. The writer fills Back() and
+// publishes it, the reader gets the newest published slot from Read(). Neither side ever waits, a value
+// the reader never picked up is simply replaced by the next one.
+template <typename T>
+class TripleBuffer {
+public:
+    T& Back() { return m_slots[m_back]; } // writer only
+    void Publish() { m_back = m_middle.exchange(m_back | kFresh, std::memory_order_acq_rel) & kIndex; }
+
+    // reader only, the reference stays valid until the next Read()
+    const T& Read() {
+        if (m_middle.load(std::memory_order_relaxed) & kFresh) {
+            m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & kIndex;
+        }
+        return m_slots[m_front];
+    }
+
+private:
+    static constexpr int kIndex = 3;
+    static constexpr int kFresh = 4; // set on the middle slot when it holds something the reader hasn't seen
+    std::array<T, 3> m_slots;
+    int m_back = 0;
+    std::atomic<int> m_middle{1};
+    int m_front = 2;
+};
+
+// Bounded queue for one producer thread and one consumer thread, Push fails instead of blocking when full.
+template <typename T, size_t N>
+class SpscQueue {
+public:
+    bool Push(const T& value) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == N) return false;
+        m_items[tail % N] = value;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+    bool Pop(T& value) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) return false;
+        value = m_items[head % N];
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::array<T, N> m_items;
+    std::atomic<size_t> m_head{0};
+    std::atomic<size_t> m_tail{0};
+};
+
+// Runs the fixed simulation ticks on their own thread so a slow draw doesn't hold the sim back and a slow
+// tick doesn't hold presentation back. Every key edge comes in through a lock-free queue and is applied in
+// order on this thread (see InputTickState), the ticks that consumed them go back through another so the main
+// thread can record input-to-sim latency. The tick publishes whatever the renderer needs (see
+// AquariumSnapshot). Off by default in code, the settings file turns it on.
+class SimThread {
+public:
+    // runs on the sim thread once per tick, returning false ends the thread (e.g. the scene asked to leave)
+    using Tick = std::function<bool(const InputFrame& input)>;
+
+    ~SimThread() { Stop(); }
+    void Load(const string& settingsPath); // <threaded_sim> from the settings file
+    bool IsEnabled() const { return m_enabled; }
+    bool IsRunning() const { return m_thread.joinable(); }
+
+    void Start(Tick tick);
+    void Stop(); // waits for the tick in flight
+    bool PushInput(const InputEdge& edge); // main thread, false when the queue is full (try again next frame)
+    // main thread: an edge some tick consumed and when, so input latency is measured where the sim took it
+    bool PopConsumed(InputEdge& edge, uint64_t& consumedMicros);
+
+    float GetLastTickMillis() const { return m_lastTickMillis.load(std::memory_order_relaxed); }
+    string Report() const;
+
+private:
+    void run();
+    InputFrame drainInput();
+    void reportConsumed();
+
+    static constexpr int kMaxTicksPerWake = 5; // past this we drop time instead of spiraling, like the frame loop
+
+    bool m_enabled = false;
+    Tick m_tick;
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    struct ConsumedEdge {
+        InputEdge edge;
+        uint64_t consumedMicros = 0;
+    };
+    SpscQueue<InputEdge, 64> m_input;
+    SpscQueue<ConsumedEdge, 64> m_consumed; // full only while the main thread stalls, samples are dropped then
+    // sim thread: the key state, an edge popped for a tick that already changed its key, and the edges the
+    // tick in flight took (at most one per key), reported once it has published
+    InputTickState m_inputState;
+    InputEdge m_deferred;
+    bool m_hasDeferred = false;
+    std::array<ConsumedEdge, static_cast<size_t>(InputKey::COUNT)> m_tickEdges;
+    size_t m_tickEdgeCount = 0;
+
+    std::atomic<uint64_t> m_ticks{0};
+    std::atomic<uint64_t> m_droppedWakes{0}; // times the thread fell behind and skipped ahead
+    std::atomic<float> m_lastTickMillis{0.0f};
+    std::atomic<float> m_maxTickMillis{0.0f};
+};
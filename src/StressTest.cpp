@@ -0,0 +1,524 @@
+#include "StressTest.h"
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include "Aquarium.h"
+#ifdef TARGET_WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+    struct StressConfig {
+        int ticks = 3600;
+        int runs = 5; // timings are the median over the runs
+        unsigned int seed = 1;
+        int width = 1024;
+        int height = 768;
+        bool defaultLevels = false; // the game's level sequence instead of one fixed population
+        std::vector<std::pair<AquariumCreatureType, int>> population = {
+            {AquariumCreatureType::NPCreature, 200},
+            {AquariumCreatureType::BiggerFish, 50},
+            {AquariumCreatureType::ZaggyFish, 50},
+            {AquariumCreatureType::Slowfish, 50},
+        };
+        bool boss = false;
+        float projectileRate = 0.0f; // extra boss shots per second on top of its own cooldown
+        string replayPath;
+        string outPath;
+        string baselinePath;
+        float threshold = 0.10f;
+        float floorMillis = 0.01f; // timing changes smaller than this are noise whatever the threshold says
+        bool writeBaseline = false;
+    };
+
+    // one level holding the configured population forever, its target score can't be reached
+    class StressLevel : public AquariumLevel {
+    public:
+        StressLevel(const std::vector<std::pair<AquariumCreatureType, int>>& population)
+        : AquariumLevel(0, std::numeric_limits<int>::max()) {
+            for (const auto& node : population) {
+                this->m_levelPopulation.push_back(MakeTracked<AquariumLevelPopulationNode>(MemoryTag::LEVELS, node.first, node.second));
+            }
+        }
+    };
+
+    struct StressResult {
+        int ticks = 0;
+        double ticksPerSecond = 0.0;
+        double p50Millis = 0.0;
+        double p99Millis = 0.0;
+        double maxMillis = 0.0;
+        double snapshotP50Millis = 0.0; // handing the tick to the renderer, not part of the tick timings
+        double snapshotP99Millis = 0.0;
+        double peakTrackedKb = 0.0;
+        double peakRssKb = 0.0; // the whole process, from the OS
+        double steadyHeapAllocs = 0.0; // untracked heap allocations after the first second, see FrameArena
+        double steadyHeapAllocsTotal = 0.0; // the same with spawned creatures, shots and events, which are tracked
+        double arenaPeakKb = 0.0;
+        int finalCreatures = 0;
+        int finalScore = 0;
+    };
+
+    bool ParseCreatureType(const string& name, AquariumCreatureType& type) {
+        if (name == "base") type = AquariumCreatureType::NPCreature;
+        else if (name == "bigger") type = AquariumCreatureType::BiggerFish;
+        else if (name == "zaggy") type = AquariumCreatureType::ZaggyFish;
+        else if (name == "slow") type = AquariumCreatureType::Slowfish;
+        else return false;
+        return true;
+    }
+
+    const char* CreatureTypeArg(AquariumCreatureType type) {
+        switch (type) {
+            case AquariumCreatureType::NPCreature: return "base";
+            case AquariumCreatureType::BiggerFish: return "bigger";
+            case AquariumCreatureType::ZaggyFish: return "zaggy";
+            case AquariumCreatureType::Slowfish: return "slow";
+            default: return "unknown";
+        }
+    }
+
+    // the whole value has to be a number, std::stoi alone takes "12x" as 12
+    template<typename T> T ParseValue(const string& value) {
+        std::istringstream in(value);
+        T number;
+        if (!(in >> number) || !(in >> std::ws).eof()) {
+            throw std::invalid_argument(value);
+        }
+        return number;
+    }
+
+    bool ParseArgs(const std::vector<string>& args, StressConfig& config) {
+        for (size_t i = 0; i < args.size(); ++i) {
+            const string& arg = args[i];
+            auto next = [&](string& value) {
+                if (i + 1 >= args.size()) return false;
+                value = args[++i];
+                return true;
+            };
+            string value;
+            try {
+                if (arg == "--boss") {
+                    config.boss = true;
+                } else if (arg == "--write-baseline") {
+                    config.writeBaseline = true;
+                } else if (!next(value)) {
+                    std::cerr << "stress: " << arg << " is unknown or is missing its value" << std::endl;
+                    return false;
+                } else if (arg == "--ticks") {
+                    config.ticks = std::max(1, ParseValue<int>(value));
+                } else if (arg == "--runs") {
+                    config.runs = std::max(1, ParseValue<int>(value));
+                } else if (arg == "--seed") {
+                    config.seed = ParseValue<unsigned int>(value);
+                } else if (arg == "--size") {
+                    char x = 0;
+                    std::istringstream size(value);
+                    if (!(size >> config.width >> x >> config.height) || x != 'x' || !(size >> std::ws).eof()
+                        || config.width <= 0 || config.height <= 0) {
+                        throw std::invalid_argument(value);
+                    }
+                } else if (arg == "--levels") {
+                    if (value != "default" && value != "fixed") throw std::invalid_argument(value);
+                    config.defaultLevels = value == "default";
+                } else if (arg == "--population") {
+                    config.population.clear();
+                    std::istringstream entries(value);
+                    string entry;
+                    while (std::getline(entries, entry, ',')) {
+                        size_t equals = entry.find('=');
+                        AquariumCreatureType type;
+                        if (equals == string::npos || !ParseCreatureType(entry.substr(0, equals), type)) {
+                            std::cerr << "stress: bad population entry " << entry << std::endl;
+                            return false;
+                        }
+                        config.population.push_back({type, std::max(0, ParseValue<int>(entry.substr(equals + 1)))});
+                    }
+                } else if (arg == "--projectile-rate") {
+                    config.projectileRate = std::max(0.0f, ParseValue<float>(value));
+                } else if (arg == "--replay") {
+                    config.replayPath = value;
+                } else if (arg == "--out") {
+                    config.outPath = value;
+                } else if (arg == "--baseline") {
+                    config.baselinePath = value;
+                } else if (arg == "--threshold") {
+                    config.threshold = ParseValue<float>(value);
+                } else if (arg == "--floor-ms") {
+                    config.floorMillis = std::max(0.0f, ParseValue<float>(value));
+                } else {
+                    std::cerr << "stress: unknown option " << arg << std::endl;
+                    return false;
+                }
+            } catch (const std::invalid_argument&) {
+                std::cerr << "stress: " << value << " is not a valid value for " << arg << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // everything about a run that changes what it measures, a baseline only gates a run with the same one
+    string ConfigTag(const StressConfig& config) {
+        std::ostringstream tag;
+        tag << "ticks=" << config.ticks << " seed=" << config.seed << " size=" << config.width << "x" << config.height;
+        if (config.defaultLevels) {
+            tag << " levels=default";
+        } else {
+            tag << " population=";
+            for (size_t i = 0; i < config.population.size(); ++i) {
+                tag << (i > 0 ? "," : "") << CreatureTypeArg(config.population[i].first) << "=" << config.population[i].second;
+            }
+        }
+        tag << " boss=" << (config.boss ? "true" : "false") << " projectile-rate=" << config.projectileRate;
+        if (!config.replayPath.empty()) {
+            tag << " replay=" << config.replayPath;
+        }
+        return tag.str();
+    }
+
+    // tick -> held keys, from a replay file
+    std::map<int, uint32_t> LoadReplay(const string& path) {
+        std::map<int, uint32_t> changes;
+        std::ifstream in(path);
+        int tick;
+        uint32_t held;
+        while (in >> tick >> held) {
+            changes[tick] = held;
+        }
+        return changes;
+    }
+
+    // without a replay the player swims a slow circle through the 8 directions, a new one every second
+    uint32_t ScriptedInput(int tick) {
+        static const uint32_t kUp = 1u << int(InputKey::UP), kDown = 1u << int(InputKey::DOWN);
+        static const uint32_t kLeft = 1u << int(InputKey::LEFT), kRight = 1u << int(InputKey::RIGHT);
+        static const uint32_t kDirections[] = {kRight, kRight | kDown, kDown, kDown | kLeft, kLeft, kLeft | kUp, kUp, kUp | kRight};
+        return kDirections[(tick / 60) % 8];
+    }
+
+    int64_t TrackedBytes() {
+        int64_t total = 0;
+        for (int tag = 0; tag < int(MemoryTag::COUNT); ++tag) {
+            total += MemoryTracker::GetStats(MemoryTag(tag)).liveBytes;
+        }
+        return total;
+    }
+
+    // peak resident set of the process so far, in KB
+    double PeakRssKb() {
+#ifdef TARGET_WIN32
+        PROCESS_MEMORY_COUNTERS counters;
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0.0;
+        return counters.PeakWorkingSetSize / 1024.0;
+#else
+        rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0) return 0.0;
+#ifdef TARGET_OSX
+        return usage.ru_maxrss / 1024.0; // bytes on macOS
+#else
+        return double(usage.ru_maxrss); // KB on Linux
+#endif
+#endif
+    }
+
+    // timings only mean something against a baseline from the same build, this is what gets compared
+    constexpr int kWarmupTicks = 60; // snapshot buffers and the frame arena find their size in here
+
+    StressResult Run(const StressConfig& config) {
+        auto aquarium = std::make_shared<Aquarium>(config.width, config.height, nullptr, config.seed);
+        if (config.defaultLevels) {
+            AddDefaultAquariumLevels(aquarium);
+        } else {
+            aquarium->addAquariumLevel(MakeTracked<StressLevel>(MemoryTag::LEVELS, config.population));
+        }
+        aquarium->Repopulate();
+
+        auto player = MakeTracked<PlayerCreature>(MemoryTag::CREATURES, config.width / 2 - 50, config.height / 2 - 50, 5, nullptr);
+        player->setBounds(config.width - 20, config.height - 20);
+        player->setLives(std::numeric_limits<int>::max()); // the run is about load, not about surviving it
+        AquariumGameScene scene(GameSceneKind::AQUARIUM_GAME, player, aquarium);
+
+        if (config.boss) {
+            aquarium->SpawnCreature(AquariumCreatureType::BossFish, player);
+            auto boss = aquarium->getBoss();
+            if (boss && config.projectileRate > 0.0f) {
+                BossFish* shooter = boss.get();
+                aquarium->GetScheduler().Register(boss, 1.0f / config.projectileRate, [shooter](float) { shooter->shootAttack(); });
+            }
+        }
+
+        std::map<int, uint32_t> replay;
+        if (!config.replayPath.empty()) {
+            replay = LoadReplay(config.replayPath);
+        }
+
+        using Clock = std::chrono::steady_clock;
+        std::vector<double> tickMillis(config.ticks);
+        std::vector<double> snapshotMillis(config.ticks);
+        double snapshotSeconds = 0.0;
+        int64_t peakBytes = TrackedBytes();
+        uint64_t steadyHeapAllocs = 0;
+        uint64_t steadyHeapAllocsTotal = 0;
+        uint32_t held = 0;
+        Clock::time_point start = Clock::now();
+        for (int tick = 0; tick < config.ticks; ++tick) {
+            InputFrame input;
+            uint32_t next = held;
+            if (config.replayPath.empty()) {
+                next = ScriptedInput(tick);
+            } else if (auto change = replay.find(tick); change != replay.end()) {
+                next = change->second;
+            }
+            input.held = next;
+            input.changed = next != held;
+            held = next;
+
+            uint64_t heapBefore = MemoryTracker::GetThreadUntrackedHeapAllocations();
+            uint64_t heapTotalBefore = MemoryTracker::GetThreadHeapAllocations();
+            Clock::time_point tickStart = Clock::now();
+            scene.ApplyInput(input);
+            scene.Step(kFixedTickSeconds);
+            Clock::time_point snapshotStart = Clock::now();
+            scene.PublishSnapshot(); // the rest of what the game's sim thread runs per tick, timed on its own
+            Clock::time_point snapshotEnd = Clock::now();
+            tickMillis[tick] = std::chrono::duration<double, std::milli>(snapshotStart - tickStart).count();
+            snapshotMillis[tick] = std::chrono::duration<double, std::milli>(snapshotEnd - snapshotStart).count();
+            snapshotSeconds += snapshotMillis[tick] / 1000.0;
+            if (tick >= kWarmupTicks) {
+                steadyHeapAllocs += MemoryTracker::GetThreadUntrackedHeapAllocations() - heapBefore;
+                steadyHeapAllocsTotal += MemoryTracker::GetThreadHeapAllocations() - heapTotalBefore;
+            }
+            peakBytes = std::max(peakBytes, TrackedBytes());
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        StressResult result;
+        result.ticks = config.ticks;
+        result.ticksPerSecond = config.ticks / std::max(seconds - snapshotSeconds, 1e-9);
+        std::sort(tickMillis.begin(), tickMillis.end());
+        result.p50Millis = tickMillis[size_t(0.50 * (tickMillis.size() - 1))];
+        result.p99Millis = tickMillis[size_t(0.99 * (tickMillis.size() - 1))];
+        result.maxMillis = tickMillis.back();
+        std::sort(snapshotMillis.begin(), snapshotMillis.end());
+        result.snapshotP50Millis = snapshotMillis[size_t(0.50 * (snapshotMillis.size() - 1))];
+        result.snapshotP99Millis = snapshotMillis[size_t(0.99 * (snapshotMillis.size() - 1))];
+        result.peakTrackedKb = peakBytes / 1024.0;
+        result.steadyHeapAllocs = double(steadyHeapAllocs);
+        result.steadyHeapAllocsTotal = double(steadyHeapAllocsTotal);
+        result.arenaPeakKb = aquarium->GetFrameArena().GetPeakBytes() / 1024.0;
+        result.finalCreatures = aquarium->getCreatureCount();
+        result.finalScore = player->getScore();
+        return result;
+    }
+
+    double Median(std::vector<double> values) {
+        std::sort(values.begin(), values.end());
+        return values[values.size() / 2];
+    }
+
+    // timings are medians over the runs, so one run that got descheduled doesn't decide the gate. Memory and
+    // heap counts are deterministic, the worst run is kept.
+    StressResult Summarize(const std::vector<StressResult>& runs) {
+        auto median = [&runs](double StressResult::*metric) {
+            std::vector<double> values;
+            for (const StressResult& run : runs) values.push_back(run.*metric);
+            return Median(std::move(values));
+        };
+        StressResult result = runs.back();
+        result.ticksPerSecond = median(&StressResult::ticksPerSecond);
+        result.p50Millis = median(&StressResult::p50Millis);
+        result.p99Millis = median(&StressResult::p99Millis);
+        result.maxMillis = median(&StressResult::maxMillis);
+        result.snapshotP50Millis = median(&StressResult::snapshotP50Millis);
+        result.snapshotP99Millis = median(&StressResult::snapshotP99Millis);
+        for (const StressResult& run : runs) {
+            result.peakTrackedKb = std::max(result.peakTrackedKb, run.peakTrackedKb);
+            result.steadyHeapAllocs = std::max(result.steadyHeapAllocs, run.steadyHeapAllocs);
+            result.steadyHeapAllocsTotal = std::max(result.steadyHeapAllocsTotal, run.steadyHeapAllocsTotal);
+            result.arenaPeakKb = std::max(result.arenaPeakKb, run.arenaPeakKb);
+        }
+        result.peakRssKb = PeakRssKb();
+        return result;
+    }
+
+    string ToJson(const StressConfig& config, const StressResult& result) {
+        std::ostringstream out;
+        out.setf(std::ios::fixed);
+        out.precision(6);
+        out << "{\n"
+            << "  \"build\": \"" << GetBuildTag() << "\",\n"
+            << "  \"config\": \"" << ConfigTag(config) << "\",\n"
+            << "  \"ticks\": " << result.ticks << ",\n"
+            << "  \"runs\": " << config.runs << ",\n"
+            << "  \"seed\": " << config.seed << ",\n"
+            << "  \"boss\": " << (config.boss ? "true" : "false") << ",\n"
+            << "  \"ticks_per_sec\": " << result.ticksPerSecond << ",\n"
+            << "  \"tick_ms_p50\": " << result.p50Millis << ",\n"
+            << "  \"tick_ms_p99\": " << result.p99Millis << ",\n"
+            << "  \"tick_ms_max\": " << result.maxMillis << ",\n"
+            << "  \"snapshot_ms_p50\": " << result.snapshotP50Millis << ",\n"
+            << "  \"snapshot_ms_p99\": " << result.snapshotP99Millis << ",\n"
+            << "  \"peak_tracked_kb\": " << result.peakTrackedKb << ",\n"
+            << "  \"peak_rss_kb\": " << result.peakRssKb << ",\n"
+            << "  \"steady_heap_allocs\": " << result.steadyHeapAllocs << ",\n"
+            << "  \"steady_heap_allocs_total\": " << result.steadyHeapAllocsTotal << ",\n"
+            << "  \"arena_peak_kb\": " << result.arenaPeakKb << ",\n"
+            << "  \"final_creatures\": " << result.finalCreatures << ",\n"
+            << "  \"final_score\": " << result.finalScore << "\n"
+            << "}\n";
+        return out.str();
+    }
+
+    // reads "key": number pairs, enough for the files ToJson writes. Strings go to strings when it is given.
+    std::map<string, double> ReadJsonNumbers(const string& path, std::map<string, string>* strings = nullptr) {
+        std::map<string, double> values;
+        std::ifstream in(path);
+        string line;
+        while (std::getline(in, line)) {
+            size_t keyStart = line.find('"');
+            size_t keyEnd = line.find('"', keyStart + 1);
+            size_t colon = line.find(':', keyEnd);
+            if (keyStart == string::npos || keyEnd == string::npos || colon == string::npos) continue;
+            string key = line.substr(keyStart + 1, keyEnd - keyStart - 1);
+            size_t valueStart = line.find('"', colon);
+            if (valueStart != string::npos) {
+                if (strings) (*strings)[key] = line.substr(valueStart + 1, line.rfind('"') - valueStart - 1);
+                continue;
+            }
+            try {
+                values[key] = std::stod(line.substr(colon + 1));
+            } catch (const std::exception&) {
+                // not a number (true/false), not a metric
+            }
+        }
+        return values;
+    }
+
+    enum class Gate {
+        TIMING,  // relative threshold and an absolute floor, only against a baseline from the same build
+        MACHINE, // relative threshold, only against a baseline from the same build
+        ALWAYS,  // the same for a given seed on any machine, relative threshold
+        REPORT,  // shown next to the baseline, never fails the run
+    };
+
+    // true when nothing got worse than the baseline by more than the threshold
+    bool CompareToBaseline(const StressResult& result, const std::map<string, double>& baseline, bool sameBuild, const StressConfig& config) {
+        struct Metric {
+            const char* key;
+            double value;
+            bool higherIsBetter;
+            Gate gate;
+        };
+        const Metric metrics[] = {
+            {"ticks_per_sec", result.ticksPerSecond, true, Gate::TIMING},
+            {"tick_ms_p50", result.p50Millis, false, Gate::TIMING},
+            {"tick_ms_p99", result.p99Millis, false, Gate::TIMING},
+            {"tick_ms_max", result.maxMillis, false, Gate::REPORT}, // one sample, whatever the OS did at the time
+            {"snapshot_ms_p50", result.snapshotP50Millis, false, Gate::TIMING},
+            {"snapshot_ms_p99", result.snapshotP99Millis, false, Gate::TIMING},
+            {"peak_rss_kb", result.peakRssKb, false, Gate::MACHINE},
+            {"peak_tracked_kb", result.peakTrackedKb, false, Gate::ALWAYS},
+            {"steady_heap_allocs", result.steadyHeapAllocs, false, Gate::ALWAYS},
+            {"steady_heap_allocs_total", result.steadyHeapAllocsTotal, false, Gate::REPORT}, // spawns follow the game, not the engine
+        };
+        bool passed = true;
+        for (const Metric& metric : metrics) {
+            auto it = baseline.find(metric.key);
+            if (it == baseline.end() || it->second < 0.0) continue;
+            bool gated = metric.gate == Gate::ALWAYS || (sameBuild && metric.gate != Gate::REPORT);
+            bool regressed = false;
+            if (it->second == 0.0) {
+                regressed = !metric.higherIsBetter && metric.value > 0.0; // a zero baseline has to stay zero
+            } else {
+                double change = (metric.value - it->second) / it->second;
+                regressed = metric.higherIsBetter ? change < -config.threshold : change > config.threshold;
+                if (regressed && metric.gate == Gate::TIMING) {
+                    // compared as time per tick, a sub-microsecond tick can double without anyone noticing
+                    double millis = metric.higherIsBetter ? 1000.0 / std::max(metric.value, 1e-9) : metric.value;
+                    double baselineMillis = metric.higherIsBetter ? 1000.0 / it->second : it->second;
+                    regressed = millis - baselineMillis > config.floorMillis;
+                }
+            }
+            regressed = regressed && gated;
+            std::cerr << "stress: " << metric.key << " " << metric.value << " vs baseline " << it->second
+                      << (regressed ? "  REGRESSED" : "") << (gated ? "" : "  (not gated)") << std::endl;
+            passed = passed && !regressed;
+        }
+        return passed;
+    }
+}
+
+string GetBuildTag() {
+    std::ostringstream tag;
+#ifdef OF_VERSION_MAJOR
+    tag << "openFrameworks " << OF_VERSION_MAJOR << "." << OF_VERSION_MINOR << "." << OF_VERSION_PATCH;
+#else
+    tag << "no openFrameworks";
+#endif
+#if defined(__clang__)
+    tag << ", clang " << __clang_major__ << "." << __clang_minor__;
+#elif defined(__GNUC__)
+    tag << ", gcc " << __GNUC__ << "." << __GNUC_MINOR__;
+#elif defined(_MSC_VER)
+    tag << ", msvc " << _MSC_VER;
+#endif
+#if defined(__OPTIMIZE__) || (defined(_MSC_VER) && !defined(_DEBUG))
+    tag << ", optimized";
+#else
+    tag << ", debug";
+#endif
+    return tag.str();
+}
+
+int RunStressTest(const std::vector<std::string>& args) {
+    StressConfig config;
+    config.baselinePath = ofToDataPath("stress-baseline.json");
+    if (!ParseArgs(args, config)) {
+        return 2;
+    }
+    // a run that can't be compared isn't worth running
+    std::map<string, double> baseline;
+    std::map<string, string> baselineStrings;
+    if (!config.writeBaseline) {
+        baseline = ReadJsonNumbers(config.baselinePath, &baselineStrings);
+        if (baseline.empty()) {
+            std::cerr << "stress: could not read baseline " << config.baselinePath << std::endl;
+            return 2;
+        }
+        if (baselineStrings["config"] != ConfigTag(config)) {
+            std::cerr << "stress: the baseline ran \"" << baselineStrings["config"] << "\", this run is \"" << ConfigTag(config)
+                      << "\". Compare against a baseline of the same configuration (--baseline), or record one with --write-baseline." << std::endl;
+            return 2;
+        }
+    }
+
+    ofSetLogLevel(OF_LOG_WARNING); // the game logs every eat and spawn, that's not what we are timing
+    std::vector<StressResult> runs;
+    for (int run = 0; run < config.runs; ++run) {
+        runs.push_back(Run(config));
+    }
+    StressResult result = Summarize(runs);
+    string json = ToJson(config, result);
+    std::cout << json;
+    if (!config.outPath.empty()) {
+        std::ofstream(config.outPath) << json;
+    }
+
+    if (config.writeBaseline) {
+        std::ofstream(config.baselinePath) << json;
+        std::cerr << "stress: wrote baseline " << config.baselinePath << std::endl;
+        return 0;
+    }
+    bool sameBuild = baselineStrings["build"] == GetBuildTag();
+    if (!sameBuild) {
+        std::cerr << "stress: the baseline is from \"" << baselineStrings["build"] << "\", this is \"" << GetBuildTag()
+                  << "\". Timings and RSS are not gated, record the baseline with --write-baseline on the reference machine." << std::endl;
+    }
+    return CompareToBaseline(result, baseline, sameBuild, config) ? 0 : 1;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Headless load generator: builds a tank from the command line, runs it --runs times for a fixed number of
+// ticks with a scripted or replayed player, and reports the median tick timings, the render snapshot's cost
+// (timed apart from the tick), peak RSS, peak tracked memory and the heap allocations of the steady ticks as
+// JSON. steady_heap_allocs leaves out tracked allocations (spawns, shots, events) and is gated,
+// steady_heap_allocs_total counts every operator new and is only reported. With a baseline it exits non-zero
+// when a metric regressed past the threshold, so a release can be gated on sim performance. Timings also have to be worse by --floor-ms, and together with RSS they are
+// only gated when the baseline was recorded by the same build (the "build" key). The max tick is reported, not gated.
+// A baseline only compares against a run of the same configuration (the "config" key: ticks, seed, size,
+// population or levels, boss, projectile rate, replay), anything else exits 2 without comparing.
+// The baseline defaults to data/stress-baseline.json, regenerate it with --write-baseline on the reference machine.
+//
+//   Aquarium --stress [--ticks N] [--runs N] [--seed N] [--size WxH] [--levels default|fixed]
+//                     [--population base=N,bigger=N,zaggy=N,slow=N] [--boss] [--projectile-rate HZ]
+//                     [--replay FILE] [--out FILE] [--baseline FILE] [--threshold FRACTION] [--floor-ms MS]
+//                     [--write-baseline]
+//
+// A replay file has one "<tick> <held key bits>" line per input change (bits as in InputFrame::held).
+// Exit codes: 0 passed, 1 a metric regressed, 2 bad arguments, unreadable baseline or a different configuration.
+int RunStressTest(const std::vector<std::string>& args);
+
+// what a measurement was taken with: openFrameworks version (or none), compiler, optimized or not
+std::string GetBuildTag();
@@ -0,0 +1,101 @@
+#include "ThinkScheduler.h"
+#include <chrono>
+
+
+void ThinkScheduler::Register(std::weak_ptr<const void> owner, float intervalSeconds, Think think) {
+    Job job{std::move(owner), std::max(0.0f, intervalSeconds), m_time + intervalSeconds, m_time, std::move(think)};
+    if (m_running) {
+        m_registered.push_back(std::move(job));
+    } else {
+        m_jobs.push_back(std::move(job));
+    }
+}
+
+void ThinkScheduler::Clear() {
+    m_jobs.clear();
+    m_registered.clear();
+    m_cursor = 0;
+}
+
+void ThinkScheduler::Load(const string& settingsPath) {
+    ofXml settings;
+    if (!settings.load(settingsPath)) return;
+    if (auto budget = settings.getChild("group").getChild("ai_budget_ms")) {
+        this->SetBudgetMillis(std::max(0.0f, budget.getFloatValue()));
+    }
+}
+
+void ThinkScheduler::Run(float dt) {
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point start = Clock::now();
+    m_time += dt;
+
+    // forget thinks whose creature is gone, keeping the cursor on the same job
+    size_t kept = 0;
+    size_t cursor = 0;
+    for (size_t i = 0; i < m_jobs.size(); ++i) {
+        if (i == m_cursor) cursor = kept;
+        if (!m_jobs[i].owner.expired()) {
+            if (kept != i) m_jobs[kept] = std::move(m_jobs[i]);
+            ++kept;
+        }
+    }
+    m_jobs.resize(kept);
+    m_cursor = kept > 0 ? cursor % kept : 0;
+
+    m_running = true;
+    size_t count = m_jobs.size();
+    size_t nextCursor = m_cursor;
+    bool outOfTime = false;
+    int ran = 0;
+    for (size_t visited = 0; visited < count; ++visited) {
+        size_t i = (m_cursor + visited) % count;
+        Job& job = m_jobs[i];
+        if (job.due > m_time) continue;
+        if (!outOfTime && ran > 0 && m_budgetMillis > 0.0f) {
+            float spent = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+            if (spent >= m_budgetMillis) {
+                outOfTime = true;
+                nextCursor = i; // the next Run() starts with the first think we left out
+            }
+        }
+        if (outOfTime) {
+            ++m_stats.deferred;
+            continue;
+        }
+        auto owner = job.owner.lock();
+        if (!owner) continue;
+        m_stats.maxLateSeconds = std::max(m_stats.maxLateSeconds, m_time - job.due);
+        job.think(m_time - job.lastRun);
+        job.lastRun = m_time;
+        job.due = m_time + job.interval; // a late think doesn't get to run twice to catch up
+        ++m_stats.runs;
+        ++ran;
+    }
+    m_running = false;
+    m_cursor = nextCursor;
+
+    for (Job& job : m_registered) {
+        m_jobs.push_back(std::move(job));
+    }
+    m_registered.clear();
+
+    m_stats.jobs = (int)m_jobs.size();
+    m_stats.lastRunMillis = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+}
+
+string ThinkScheduler::Report() const {
+    return Report(m_stats, m_budgetMillis);
+}
+
+string ThinkScheduler::Report(const ThinkStats& stats, float budgetMillis) {
+    std::ostringstream out;
+    out.setf(std::ios::fixed);
+    out.precision(2);
+    out << "ai thinks " << stats.jobs << " ran " << stats.runs << " deferred " << stats.deferred
+        << " max late " << stats.maxLateSeconds << " s last run " << stats.lastRunMillis << " ms";
+    if (budgetMillis > 0.0f) {
+        out << " (budget " << budgetMillis << " ms)";
+    }
+    return out.str();
+}
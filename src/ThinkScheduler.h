@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "ofMain.h"
+
+struct ThinkStats {
+    int jobs = 0;
+    uint64_t runs = 0;
+    uint64_t deferred = 0;        // due thinks pushed to a later Run() because the budget was spent
+    float maxLateSeconds = 0.0f;  // longest a think has waited past its due time
+    float lastRunMillis = 0.0f;
+};
+
+// Runs creature decision logic (retargeting, attack choice, phase changes) at each think's own rate instead of
+// every tick, inside a time budget per Run(). Thinks that don't fit wait for the next Run(), which starts from
+// the first one that was left out, so nothing starves for long.
+class ThinkScheduler {
+public:
+    using Think = std::function<void(float elapsed)>; // elapsed: seconds since this think last ran
+
+    // the think is dropped once its owner is gone, and only runs while the owner is alive
+    void Register(std::weak_ptr<const void> owner, float intervalSeconds, Think think);
+    void Clear();
+
+    void Load(const string& settingsPath); // <ai_budget_ms> from the settings file
+    void SetBudgetMillis(float millis) { m_budgetMillis = millis; } // 0 runs every due think, headless tanks want that
+    float GetBudgetMillis() const { return m_budgetMillis; }
+
+    void Run(float dt);
+
+    const ThinkStats& GetStats() const { return m_stats; }
+    string Report() const;
+    static string Report(const ThinkStats& stats, float budgetMillis); // for stats copied off another thread
+
+private:
+    struct Job {
+        std::weak_ptr<const void> owner;
+        float interval;
+        float due;
+        float lastRun;
+        Think think;
+    };
+
+    std::vector<Job> m_jobs;
+    std::vector<Job> m_registered; // added while thinks run, merged after
+    bool m_running = false;
+    size_t m_cursor = 0; // where the next Run() starts
+    float m_time = 0.0f;
+    float m_budgetMillis = 0.0f;
+    ThinkStats m_stats;
+};
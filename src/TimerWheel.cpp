@@ -0,0 +1,232 @@
+#include "TimerWheel.h"
+#include <istream>
+#include <ostream>
+
+
+void TimerWheel::SetHandler(uint16_t kind, Handler handler) {
+    if (kind >= m_handlers.size()) {
+        m_handlers.resize(kind + 1);
+    }
+    m_handlers[kind] = std::move(handler);
+}
+
+TimerHandle TimerWheel::Schedule(uint64_t delayTicks, uint16_t kind, uint64_t payload, uint64_t periodTicks) {
+    uint32_t index;
+    if (!m_free.empty()) {
+        index = m_free.back();
+        m_free.pop_back();
+    } else {
+        index = static_cast<uint32_t>(m_nodes.size());
+        m_nodes.emplace_back();
+        m_free.reserve(m_nodes.capacity()); // so firing and cancelling never allocate
+    }
+    Node& node = m_nodes[index];
+    node.due = m_tick + std::clamp<uint64_t>(delayTicks, 1, kMaxDelay);
+    node.period = std::min(periodTicks, kMaxDelay);
+    node.payload = payload;
+    node.kind = kind;
+    node.active = true;
+    this->insert(index);
+    ++m_pending;
+    return TimerHandle{index, node.generation};
+}
+
+void TimerWheel::Cancel(TimerHandle& timer) {
+    if (this->IsPending(timer)) {
+        this->unlink(timer.index);
+        this->release(timer.index);
+    }
+    timer = TimerHandle{};
+}
+
+bool TimerWheel::IsPending(TimerHandle timer) const {
+    return timer.index < m_nodes.size() && m_nodes[timer.index].active && m_nodes[timer.index].generation == timer.generation;
+}
+
+uint64_t TimerWheel::GetRemaining(TimerHandle timer) const {
+    return this->IsPending(timer) ? m_nodes[timer.index].due - m_tick : 0;
+}
+
+void TimerWheel::insert(uint32_t index) {
+    Node& node = m_nodes[index];
+    // the lowest level whose window still holds the due tick, anything further out waits in the top level
+    int level = 0;
+    while (level < kLevels - 1 && (node.due >> ((level + 1) * kSlotBits)) != (m_tick >> ((level + 1) * kSlotBits))) {
+        ++level;
+    }
+    node.list = uint16_t(level * kSlots + ((node.due >> (level * kSlotBits)) & (kSlots - 1)));
+    uint32_t* head = &this->head(node.list);
+    // append so timers due on the same tick fire in the order they were scheduled, a slot list is kept
+    // circular through the head's prev to make that O(1)
+    node.next = kNone;
+    if (*head == kNone) {
+        node.prev = index;
+        *head = index;
+    } else {
+        uint32_t tail = m_nodes[*head].prev;
+        node.prev = tail;
+        m_nodes[tail].next = index;
+        m_nodes[*head].prev = index;
+    }
+}
+
+void TimerWheel::unlink(uint32_t index) {
+    Node& node = m_nodes[index];
+    uint32_t& head = this->head(node.list);
+    if (head == index) {
+        head = node.next;
+        if (head != kNone) m_nodes[head].prev = node.prev;
+    } else {
+        m_nodes[node.prev].next = node.next;
+        if (node.next != kNone) {
+            m_nodes[node.next].prev = node.prev;
+        } else {
+            m_nodes[head].prev = node.prev; // it was the tail
+        }
+    }
+    node.list = kNoList;
+    node.prev = node.next = kNone;
+}
+
+void TimerWheel::release(uint32_t index) {
+    Node& node = m_nodes[index];
+    node.active = false;
+    ++node.generation;
+    m_free.push_back(index);
+    --m_pending;
+}
+
+void TimerWheel::cascade(int level) {
+    uint32_t& head = m_slots[level][(m_tick >> (level * kSlotBits)) & (kSlots - 1)];
+    while (head != kNone) {
+        uint32_t index = head;
+        this->unlink(index);
+        this->insert(index);
+    }
+}
+
+void TimerWheel::Advance() {
+    ++m_tick;
+    for (int level = kLevels - 1; level > 0; --level) {
+        if ((m_tick & ((uint64_t(1) << (level * kSlotBits)) - 1)) == 0) {
+            this->cascade(level);
+        }
+    }
+    // one node at a time, a handler is free to schedule or cancel anything, this slot included
+    uint32_t& head = m_slots[0][m_tick & (kSlots - 1)];
+    while (head != kNone) {
+        uint32_t index = head;
+        this->unlink(index);
+        Node& node = m_nodes[index];
+        TimerHandle timer{index, node.generation};
+        uint16_t kind = node.kind;
+        uint64_t payload = node.payload;
+        if (node.period > 0) {
+            node.due += node.period;
+            this->insert(index);
+        } else {
+            this->release(index);
+        }
+        ++m_fired;
+        if (kind < m_handlers.size() && m_handlers[kind]) {
+            m_handlers[kind](timer, payload);
+        }
+    }
+}
+
+void TimerWheel::Save(std::ostream& out) const {
+    out << "timers " << m_tick << " " << m_fired << " " << m_nodes.size() << "\n";
+    for (const Node& node : m_nodes) {
+        out << node.generation << " " << node.active << " " << node.due << " " << node.period << " "
+            << node.kind << " " << node.payload << "\n";
+    }
+    // slot lists in firing order, so a restored wheel fires same-tick timers in the same order
+    for (int level = 0; level < kLevels; ++level) {
+        for (uint32_t slot = 0; slot < kSlots; ++slot) {
+            uint32_t index = m_slots[level][slot];
+            if (index == kNone) continue;
+            out << "slot " << level << " " << slot;
+            for (; index != kNone; index = m_nodes[index].next) {
+                out << " " << index;
+            }
+            out << "\n";
+        }
+    }
+    out << "free";
+    for (uint32_t index : m_free) {
+        out << " " << index;
+    }
+    out << "\nend\n";
+}
+
+bool TimerWheel::Load(std::istream& in) {
+    this->Clear();
+    string word;
+    size_t count = 0;
+    if (!(in >> word >> m_tick >> m_fired >> count) || word != "timers") {
+        this->Clear();
+        return false;
+    }
+    m_nodes.resize(count);
+    for (Node& node : m_nodes) {
+        if (!(in >> node.generation >> node.active >> node.due >> node.period >> node.kind >> node.payload)) {
+            this->Clear();
+            return false;
+        }
+        if (node.active) ++m_pending;
+    }
+    string line;
+    while (in >> word && word != "end") {
+        std::getline(in, line);
+        std::istringstream fields(line);
+        uint32_t index;
+        if (word == "slot") {
+            int level;
+            uint32_t slot;
+            fields >> level >> slot;
+            if (level < 0 || level >= kLevels || slot >= kSlots) continue;
+            uint32_t* head = &m_slots[level][slot];
+            while (fields >> index) {
+                if (index >= count || !m_nodes[index].active || m_nodes[index].list != kNoList) continue;
+                // insert() would pick the slot itself, going through the saved one keeps the list order
+                Node& node = m_nodes[index];
+                node.list = uint16_t(level * kSlots + slot);
+                node.next = kNone;
+                if (*head == kNone) {
+                    node.prev = index;
+                    *head = index;
+                } else {
+                    node.prev = m_nodes[*head].prev;
+                    m_nodes[node.prev].next = index;
+                    m_nodes[*head].prev = index;
+                }
+            }
+        } else if (word == "free") {
+            while (fields >> index) {
+                if (index < count && !m_nodes[index].active) m_free.push_back(index);
+            }
+        }
+    }
+    for (uint32_t index = 0; index < count; ++index) {
+        if (m_nodes[index].active && m_nodes[index].list == kNoList) {
+            ofLogWarning("TimerWheel") << "timer " << index << " was not in any slot, rescheduling it";
+            this->insert(index);
+        }
+    }
+    return true;
+}
+
+void TimerWheel::Clear() {
+    m_nodes.clear();
+    m_free.clear();
+    m_slots = makeEmptySlots();
+    m_tick = 0;
+    m_pending = 0;
+    m_fired = 0;
+}
+
+string TimerWheel::Report() const {
+    std::ostringstream out;
+    out << "timers pending " << m_pending << " fired " << m_fired << " pool " << m_nodes.size();
+    return out.str();
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <vector>
+#include "ofMain.h"
+
+// Refers to one scheduled timer. Handles stay valid across Save/Load, a fired or cancelled timer's handle
+// simply stops matching (the slot's generation moves on).
+struct TimerHandle {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+    bool IsSet() const { return index != UINT32_MAX; }
+};
+
+// Gameplay timers at tick granularity in a hierarchical wheel: 4 levels of 256 slots, so scheduling and
+// cancelling are O(1) whatever the delay, and a tick only touches the timers due on it (plus, every 256
+// ticks, one slot of the level above moving down). Timers carry a kind and a payload instead of a closure,
+// and owners register one handler per kind, which is what lets Save/Load capture them exactly.
+// Copying a wheel snapshots its timers, the copy keeps the original's handlers until it is given its own.
+class TimerWheel {
+public:
+    using Handler = std::function<void(TimerHandle timer, uint64_t payload)>;
+
+    void SetHandler(uint16_t kind, Handler handler);
+
+    // fires delayTicks ticks from now (at least 1), then every periodTicks if that isn't 0
+    TimerHandle Schedule(uint64_t delayTicks, uint16_t kind, uint64_t payload = 0, uint64_t periodTicks = 0);
+    void Cancel(TimerHandle& timer); // no-op when it already fired, the handle is cleared either way
+    bool IsPending(TimerHandle timer) const;
+    uint64_t GetRemaining(TimerHandle timer) const; // ticks until it fires, 0 when not pending
+
+    void Advance(); // one tick, handlers run in the order their timers were scheduled
+    uint64_t GetTick() const { return m_tick; }
+    size_t GetPendingCount() const { return m_pending; }
+
+    // text, one timer per line, handlers are not part of it and have to be registered on the loading side
+    void Save(std::ostream& out) const;
+    bool Load(std::istream& in);
+    void Clear();
+    string Report() const;
+
+private:
+    static constexpr int kLevels = 4;
+    static constexpr int kSlotBits = 8;
+    static constexpr uint32_t kSlots = 1u << kSlotBits;
+    static constexpr uint32_t kNone = UINT32_MAX;
+    static constexpr uint64_t kMaxDelay = (uint64_t(1) << (kLevels * kSlotBits)) - 1;
+    static constexpr uint16_t kNoList = UINT16_MAX;
+
+    struct Node {
+        uint64_t due = 0;
+        uint64_t period = 0;
+        uint64_t payload = 0;
+        uint32_t prev = kNone;
+        uint32_t next = kNone;
+        uint32_t generation = 0;
+        uint16_t kind = 0;
+        bool active = false;
+        uint16_t list = kNoList; // the slot it is linked into, level * kSlots + slot, so a copied wheel stays whole
+    };
+
+    void insert(uint32_t index);
+    void unlink(uint32_t index);
+    void release(uint32_t index);
+    void cascade(int level);
+    uint32_t& head(uint16_t list) { return m_slots[list / kSlots][list % kSlots]; }
+
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_free;
+    std::array<std::array<uint32_t, kSlots>, kLevels> m_slots = makeEmptySlots();
+    std::vector<Handler> m_handlers;
+    uint64_t m_tick = 0;
+    size_t m_pending = 0;
+    uint64_t m_fired = 0;
+
+    static std::array<std::array<uint32_t, kSlots>, kLevels> makeEmptySlots() {
+        std::array<std::array<uint32_t, kSlots>, kLevels> slots;
+        for (auto& level : slots) level.fill(kNone);
+        return slots;
+    }
+};
@@ -0,0 +1,128 @@
+#include "VecEnvBenchmark.h"
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include "AquariumVecEnv.h"
+#include "StressTest.h"
+
+namespace {
+    struct BenchConfig {
+        int envs = 4096;
+        int steps = 600;
+        int threads = 0;
+        unsigned int seed = 1;
+        double target = 1000000.0;
+        string outPath;
+    };
+
+    // the whole value has to be a number, std::stoi alone takes "12x" as 12
+    template<typename T> T ParseValue(const string& value) {
+        std::istringstream in(value);
+        T number;
+        if (!(in >> number) || !(in >> std::ws).eof()) {
+            throw std::invalid_argument(value);
+        }
+        return number;
+    }
+
+    bool ParseArgs(const std::vector<string>& args, BenchConfig& config) {
+        for (size_t i = 0; i + 1 < args.size(); i += 2) {
+            const string& arg = args[i];
+            const string& value = args[i + 1];
+            try {
+                if (arg == "--envs") {
+                    config.envs = std::max(1, ParseValue<int>(value));
+                } else if (arg == "--steps") {
+                    config.steps = std::max(1, ParseValue<int>(value));
+                } else if (arg == "--threads") {
+                    config.threads = std::max(0, ParseValue<int>(value));
+                } else if (arg == "--seed") {
+                    config.seed = ParseValue<unsigned int>(value);
+                } else if (arg == "--target") {
+                    config.target = ParseValue<double>(value);
+                } else if (arg == "--out") {
+                    config.outPath = value;
+                } else {
+                    std::cerr << "bench-vec-env: unknown option " << arg << std::endl;
+                    return false;
+                }
+            } catch (const std::invalid_argument&) {
+                std::cerr << "bench-vec-env: " << value << " is not a valid value for " << arg << std::endl;
+                return false;
+            }
+        }
+        if (args.size() % 2 != 0) {
+            std::cerr << "bench-vec-env: " << args.back() << " is missing its value" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    constexpr int kWarmupSteps = 60; // tanks fill their snapshot buffers and arenas in here
+}
+
+int RunVecEnvBenchmark(const std::vector<std::string>& args) {
+    BenchConfig config;
+    if (!ParseArgs(args, config)) {
+        return 2;
+    }
+    ofSetLogLevel(OF_LOG_WARNING); // thousands of tanks each log their eats and lost lives as notices
+
+    AquariumVecEnv env(config.envs, config.seed, config.threads);
+    std::vector<int> actions(env.GetNumEnvs());
+    std::mt19937 random(config.seed);
+    auto randomActions = [&]() {
+        for (int& action : actions) {
+            action = int(random() % unsigned(AquariumAction::COUNT));
+        }
+    };
+
+    for (int step = 0; step < kWarmupSteps; ++step) {
+        randomActions();
+        env.Step(actions.data());
+    }
+
+    using Clock = std::chrono::steady_clock;
+    double stepSeconds = 0.0; // the random actions are the caller's cost, only Step is timed
+    uint64_t episodes = 0;
+    for (int step = 0; step < config.steps; ++step) {
+        randomActions();
+        Clock::time_point start = Clock::now();
+        env.Step(actions.data());
+        stepSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+        const uint8_t* dones = env.GetDones();
+        for (int i = 0; i < env.GetNumEnvs(); ++i) {
+            episodes += dones[i];
+        }
+    }
+
+    double tankSteps = double(config.steps) * env.GetNumEnvs();
+    double perSecond = tankSteps / std::max(stepSeconds, 1e-9);
+    unsigned int threads = config.threads > 0 ? unsigned(config.threads) : std::max(1u, std::thread::hardware_concurrency());
+
+    std::ostringstream out;
+    out.setf(std::ios::fixed);
+    out.precision(3);
+    out << "{\n"
+        << "  \"build\": \"" << GetBuildTag() << "\",\n"
+        << "  \"envs\": " << env.GetNumEnvs() << ",\n"
+        << "  \"steps\": " << config.steps << ",\n"
+        << "  \"threads\": " << threads << ",\n"
+        << "  \"tank_steps_per_sec\": " << perSecond << ",\n"
+        << "  \"tank_steps_per_sec_per_thread\": " << perSecond / threads << ",\n"
+        << "  \"target_per_sec\": " << config.target << ",\n"
+        << "  \"finished_episodes\": " << episodes << "\n"
+        << "}\n";
+    std::cout << out.str();
+    if (!config.outPath.empty()) {
+        std::ofstream(config.outPath) << out.str();
+    }
+
+    bool reached = perSecond >= config.target;
+    if (!reached) {
+        std::cerr << "bench-vec-env: " << perSecond << " tank-steps/s is below the target of " << config.target << std::endl;
+    }
+    return reached ? 0 : 1;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Headless throughput check for AquariumVecEnv: steps a batch of tanks with random actions and reports
+// tank-steps per second (one env stepping once is one tank-step) against a target, as JSON.
+//
+//   Aquarium --bench-vec-env [--envs N] [--steps N] [--threads N] [--seed N] [--target STEPS_PER_SEC] [--out FILE]
+//
+// --threads 0 (the default) uses every hardware thread, the target defaults to 1M tank-steps/s. The JSON names
+// the build it measured ("build"). The target has only been checked against a headless build without
+// openFrameworks so far, it is unverified on a real one.
+// Exit codes: 0 reached the target, 1 below it, 2 bad arguments.
+int RunVecEnvBenchmark(const std::vector<std::string>& args);
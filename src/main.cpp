@@ -1,8 +1,24 @@
 #include "ofMain.h"
 #include "ofApp.h"
+#include "SelfTest.h"
+#include "StressTest.h"
+#include "VecEnvBenchmark.h"
 
 //========================================================================
-int main( ){
+int main(int argc, char* argv[]){
+
+	// headless load test, no window, see StressTest.h
+	if(argc > 1 && std::string(argv[1]) == "--stress"){
+		return RunStressTest(std::vector<std::string>(argv + 2, argv + argc));
+	}
+	// engine unit checks, see SelfTest.h
+	if(argc > 1 && std::string(argv[1]) == "--self-test"){
+		return RunSelfTests(std::vector<std::string>(argv + 2, argv + argc));
+	}
+	// bot env throughput, see VecEnvBenchmark.h
+	if(argc > 1 && std::string(argv[1]) == "--bench-vec-env"){
+		return RunVecEnvBenchmark(std::vector<std::string>(argv + 2, argv + argc));
+	}
 
 	//Use ofGLFWWindowSettings for more options like multi-monitor fullscreen
 	ofGLWindowSettings settings;
@@ -3,15 +3,23 @@
 //--------------------------------------------------------------
 void ofApp::setup(){
 
-    ofSetFrameRate(60);
+    pacer.Load("settings.xml"); // pacing mode and frame cap, so each cabinet can be tuned without a rebuild
+    simThread.Load("settings.xml");
+    capture.Load("settings.xml");
+    governor.Load("settings.xml");
     ofSetBackgroundColor(ofColor::blue);
-    backgroundImage.load("background.png");
-    backgroundImage.resize(ofGetWindowWidth(), ofGetWindowHeight());
+    projection.SetLogicalSize(VIEW_WIDTH, VIEW_HEIGHT);
+    projection.SetWindowSize(ofGetWindowWidth(), ofGetWindowHeight());
+    LoadTextureOnly(backgroundTexture, "background.png", VIEW_WIDTH, VIEW_HEIGHT); // nothing reads its pixels
+    backgroundMemory.Set(MemoryTag::SPRITES, size_t(VIEW_WIDTH) * VIEW_HEIGHT * 4);
 
-    music.load("music/DtMF.mp3"); // background music
+    MemoryTracker::LoadBudgets("settings.xml");
+
+    music.load("music/DtMF.mp3", true); // background music, streamed instead of decoded whole at startup
     music.setLoop(true);
     music.setVolume(0.5);
     music.play();
+    sfx.Setup(); // decodes every effect now, gameplay only queues them
 
 
     std::shared_ptr<Aquarium> myAquarium;
@@ -23,32 +31,44 @@ void ofApp::setup(){
 
     // first we make the intro scene 
     gameManager->AddScene(std::make_shared<GameIntroScene>(
-        GameSceneKindToString(GameSceneKind::GAME_INTRO),
-        std::make_shared<GameSprite>("title.png", ofGetWindowWidth(), ofGetWindowHeight())
+        GameSceneKind::GAME_INTRO,
+        std::make_shared<GameSprite>("title.png", VIEW_WIDTH, VIEW_HEIGHT)
     ));
 
     //AquariumSpriteManager
     spriteManager = std::make_shared<AquariumSpriteManager>();
 
-    // Lets setup the aquarium
-    myAquarium = std::make_shared<Aquarium>(ofGetWindowWidth(), ofGetWindowHeight(), spriteManager);
-    player = std::make_shared<PlayerCreature>(ofGetWindowWidth()/2 - 50, ofGetWindowHeight()/2 - 50, DEFAULT_SPEED, this->spriteManager->GetSprite(AquariumCreatureType::NPCreature));
+    // Lets setup the aquarium, its size is the world and not the window
+    ofXml settings;
+    if(settings.load("settings.xml")){
+        if(auto scale = settings.getChild("group").getChild("world_scale")){
+            WORLD_SCALE = std::max(1, scale.getIntValue());
+        }
+    }
+    int worldWidth = VIEW_WIDTH * WORLD_SCALE;
+    int worldHeight = VIEW_HEIGHT * WORLD_SCALE;
+    myAquarium = std::make_shared<Aquarium>(worldWidth, worldHeight, spriteManager);
+    myAquarium->GetScheduler().Load("settings.xml"); // per-tick time budget for creature thinks
+    player = MakeTracked<PlayerCreature>(MemoryTag::CREATURES, worldWidth/2 - 50, worldHeight/2 - 50, DEFAULT_SPEED, this->spriteManager->GetSprite(AquariumCreatureType::NPCreature));
     player->setDirection(0, 0); // Initially stationary
-    player->setBounds(ofGetWindowWidth() - 20, ofGetWindowHeight() - 20);
+    player->setBounds(worldWidth - 20, worldHeight - 20);
 
 
-    myAquarium->addAquariumLevel(std::make_shared<Level_0>(0, 10));
-    myAquarium->addAquariumLevel(std::make_shared<Level_1>(1, 15));
-    myAquarium->addAquariumLevel(std::make_shared<Level_2>(2, 20));
-    myAquarium->addAquariumLevel(std::make_shared<Level_3>(3, 25)); // this level ends when the player reaches 25 points
-    myAquarium->addAquariumLevel(std::make_shared<Level_4>(4, 30)); // this level ends when the player reaches 30 points
-    myAquarium->addAquariumLevel(std::make_shared<Level_Boss>(5, 40)); // this level ends when the player reaches 40 points
+    AddDefaultAquariumLevels(myAquarium);
+    // the boss level is the last one, give it its own background
+    myAquarium->getAquariumLevels().back()->setBackGSprite(std::make_shared<GameSprite>("backgroundBoss.png", VIEW_WIDTH, VIEW_HEIGHT));
     myAquarium->Repopulate(); // initial population
 
     // now that we are mostly set, lets pass the player and the aquarium downstream
-    gameManager->AddScene(std::make_shared<AquariumGameScene>(
-        std::move(player), std::move(myAquarium), GameSceneKindToString(GameSceneKind::AQUARIUM_GAME)
-    )); // player and aquarium are owned by the scene moving forward
+    auto aquariumScene = std::make_shared<AquariumGameScene>(
+        GameSceneKind::AQUARIUM_GAME, std::move(player), std::move(myAquarium)
+    ); // player and aquarium are owned by the scene moving forward
+    aquariumScene->GetCamera().SetViewportSize(VIEW_WIDTH, VIEW_HEIGHT);
+    aquariumScene->GetCamera().SetProjection(projection);
+    auto particles = std::make_shared<ParticleSystem>();
+    particles->Load("settings.xml"); // reserves the whole particle budget now
+    aquariumScene->SetParticles(particles);
+    gameManager->AddScene(aquariumScene);
 
     // Load font for game over message
     gameOverTitle.load("Verdana.ttf", 12, true, true);
@@ -57,44 +77,160 @@ void ofApp::setup(){
 
 
     gameManager->AddScene(std::make_shared<GameOverScene>(
-        GameSceneKindToString(GameSceneKind::GAME_OVER),
-        std::make_shared<GameSprite>("game-over.png", ofGetWindowWidth(), ofGetWindowHeight())
+        GameSceneKind::GAME_OVER,
+        std::make_shared<GameSprite>("game-over.png", VIEW_WIDTH, VIEW_HEIGHT)
     ));
+    // warm the game up while the title is showing
+    gameManager->PreloadScene(GameSceneKind::AQUARIUM_GAME);
 
     ofSetLogLevel(OF_LOG_NOTICE); // Set default log level
 }
 
 //--------------------------------------------------------------
 void ofApp::update(){
-    
-    if(gameManager->GetActiveSceneName() == GameSceneKindToString(GameSceneKind::GAME_OVER)){
-        return; // Stop updating if game is over or exiting
+    pacer.BeginFrame(); // in low latency mode this sleeps and then polls events, so input is sampled as late as possible
+    if(simThread.IsEnabled()){
+        this->syncSimThread();
+    } else {
+        this->stepSimulation();
     }
+    // releases only reach the sampler while the game is active, keys still down when it ends would stay held
+    GameSceneKind sceneKind = gameManager->GetActiveSceneKind();
+    if(inputSceneKind == GameSceneKind::AQUARIUM_GAME && sceneKind != GameSceneKind::AQUARIUM_GAME){
+        input.Reset();
+    }
+    inputSceneKind = sceneKind;
 
-    if(gameManager->GetActiveSceneName() == GameSceneKindToString(GameSceneKind::AQUARIUM_GAME)){
-        auto gameScene = std::static_pointer_cast<AquariumGameScene>(gameManager->GetActiveScene());
-        if(gameScene->GetLastEvent() != nullptr && gameScene->GetLastEvent()->isGameOver()){
-            gameManager->Transition(GameSceneKindToString(GameSceneKind::GAME_OVER));
-            return;
-        }
-        
+    MemoryTracker::CheckBudgets();
+    memoryReportTimer += ofGetLastFrameTime();
+    if(memoryReportTimer >= MEMORY_REPORT_SECONDS){
+        memoryReportTimer = 0.0f;
+        MemoryTracker::AppendReport(ofToDataPath("memory-report.txt"));
     }
+}
 
-    gameManager->UpdateActiveScene();
-    
+//--------------------------------------------------------------
+void ofApp::stepSimulation(){
+    auto start = std::chrono::steady_clock::now();
+    simAccumulator += ofGetLastFrameTime();
+    int ticks = 0;
+    while(simAccumulator >= kFixedTickSeconds && ticks < MAX_TICKS_PER_FRAME){
+        simAccumulator -= kFixedTickSeconds;
+        ++ticks;
+        if(gameManager->GetActiveSceneKind() == GameSceneKind::AQUARIUM_GAME){
+            auto gameScene = std::static_pointer_cast<AquariumGameScene>(gameManager->GetActiveScene());
+            gameScene->ApplyInput(input.ConsumeTick());
+        }
+        // scenes request their own transitions (the game asks for GAME_OVER when the player dies)
+        gameManager->UpdateActiveScene();
+    }
+    if(ticks == MAX_TICKS_PER_FRAME){
+        simAccumulator = 0.0f; // we fell too far behind (window drag, breakpoint), don't try to catch up
+    }
+    simMillis = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
 
+//--------------------------------------------------------------
+void ofApp::applyLoadScale(float drawMillis){
+    // on the sim thread ticks overlap drawing, the slower of the two sets the pace
+    float cost = simThread.IsEnabled() ? std::max(simThread.GetLastTickMillis(), drawMillis) : simMillis + drawMillis;
+    if(!governor.AddFrame(cost, ofGetLastFrameTime())){
+        return;
+    }
+    auto aquariumScene = std::static_pointer_cast<AquariumGameScene>(gameManager->GetScene(GameSceneKind::AQUARIUM_GAME));
+    aquariumScene->GetAquarium()->SetLoadScale(governor.GetScale()); // atomic, the sim picks it up on its next repopulate
+    if(aquariumScene->GetParticles()){
+        aquariumScene->GetParticles()->SetLoadScale(governor.GetScale());
+    }
+}
 
+//--------------------------------------------------------------
+void ofApp::syncSimThread(){
+    if(gameManager->GetActiveSceneKind() != GameSceneKind::AQUARIUM_GAME){
+        gameManager->UpdateActiveScene(); // title and game over are static, they stay on the main thread
+        return;
+    }
+    if(!simThread.IsRunning()){
+        auto gameScene = std::static_pointer_cast<AquariumGameScene>(gameManager->GetActiveScene());
+        simThread.Start([gameScene](const InputFrame& frame){
+            gameScene->ApplyInput(frame);
+            gameScene->Update();
+            return !gameScene->HasTransitionRequest(); // game over, the main thread takes it from here
+        });
+    }
+    // every key edge since the last frame, the sim thread applies them in order over its next ticks
+    input.ForwardEdges([this](const InputEdge& edge){ return simThread.PushInput(edge); });
+    InputEdge consumed;
+    uint64_t consumedMicros;
+    while(simThread.PopConsumed(consumed, consumedMicros)){
+        input.EdgeConsumed(consumed.stampMicros, consumedMicros);
+    }
+    gameManager->TakeTransition();
+    if(gameManager->GetActiveSceneKind() != GameSceneKind::AQUARIUM_GAME){
+        simThread.Stop();
+    }
 }
 
 //--------------------------------------------------------------
 void ofApp::draw(){
-    backgroundImage.draw(0, 0);
+    auto drawStart = std::chrono::steady_clock::now();
+    auto scene = gameManager->GetActiveScene();
+    scene->BeginDraw(); // the static layer, the scene and the overlays below all see the same tick
+    if(scene.get() != staticLayerScene){
+        staticLayer.Invalidate(); // a different scene means a different backdrop
+        staticLayerScene = scene.get();
+    }
+    staticLayer.Draw(ofGetWindowWidth(), ofGetWindowHeight(), scene->GetStaticKey(), [&](){
+        backgroundTexture.draw(0, 0, ofGetWindowWidth(), ofGetWindowHeight()); // fills the letterbox bars too
+        projection.Begin();
+        scene->DrawStatic();
+        projection.End();
+    });
     gameManager->DrawActiveScene();
+    capture.CaptureFrame(); // before the overlays, recordings show the game only
+    if(gameManager->GetActiveSceneKind() == GameSceneKind::AQUARIUM_GAME){
+        this->applyLoadScale(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - drawStart).count());
+    }
+    if(showStats){
+        auto aquariumScene = std::static_pointer_cast<AquariumGameScene>(gameManager->GetScene(GameSceneKind::AQUARIUM_GAME));
+        const AquariumSnapshot& view = aquariumScene->GetView(); // the sim may be mid-tick, this is what the frame drew
+        ofDrawBitmapStringHighlight("sim lod near " + ofToString(view.lodCounts[static_cast<size_t>(SimLod::NEAR_PLAYER)])
+            + " mid " + ofToString(view.lodCounts[static_cast<size_t>(SimLod::MID_RANGE)])
+            + " far " + ofToString(view.lodCounts[static_cast<size_t>(SimLod::FAR_AWAY)]), 10, ofGetWindowHeight() - 70);
+        ofDrawBitmapStringHighlight(ThinkScheduler::Report(view.thinks, view.thinkBudgetMillis), 10, ofGetWindowHeight() - 50);
+        ofDrawBitmapStringHighlight("tick memory arena peak " + ofToString(view.arenaPeakBytes / 1024) + " kb, "
+            + ofToString(view.heapTicks) + " of " + ofToString(view.tick) + " ticks hit the heap", 10, ofGetWindowHeight() - 170);
+        ofDrawBitmapStringHighlight(simThread.Report(), 10, ofGetWindowHeight() - 110);
+        ofDrawBitmapStringHighlight(governor.Report(), 10, ofGetWindowHeight() - 150);
+        if(capture.IsRecording()){
+            ofDrawBitmapStringHighlight(capture.Report(), 10, ofGetWindowHeight() - 130);
+        }
+        if (aquariumScene->GetParticles()) {
+            ofDrawBitmapStringHighlight(aquariumScene->GetParticles()->Report(), 10, ofGetWindowHeight() - 90);
+        }
+        ofDrawBitmapStringHighlight(pacer.Report(), 10, ofGetWindowHeight() - 30);
+        ofDrawBitmapStringHighlight(input.Report(), 10, ofGetWindowHeight() - 10);
+    }
+    if(showMemory){
+        ofDrawBitmapStringHighlight(MemoryTracker::Report(), 10, 20);
+    }
+    input.FramePresented();
+    pacer.EndFrame();
 }
 
 //--------------------------------------------------------------
 void ofApp::exit(){
-    
+    simThread.Stop(); // everything below reads sim state
+    capture.Stop();
+    ofLogNotice() << "Simulation: " << simThread.Report();
+    ofLogNotice() << "Input latency: " << input.Report();
+    ofLogNotice() << "Frame pacing: " << pacer.Report();
+    auto aquariumScene = std::static_pointer_cast<AquariumGameScene>(gameManager->GetScene(GameSceneKind::AQUARIUM_GAME));
+    ofLogNotice() << "AI scheduler: " << aquariumScene->GetAquarium()->GetScheduler().Report();
+    pacer.GetHistogram().WriteCsv(ofToDataPath("frame-times.csv"));
+    MemoryTracker::AppendReport(ofToDataPath("memory-report.txt"));
+    ofLogNotice() << "Sound effects: " << sfx.Report();
+    sfx.Close();
 }
 
 //--------------------------------------------------------------
@@ -103,39 +239,36 @@ void ofApp::keyPressed(int key){
         ofLogNotice() << "Game has ended. Press ESC to exit." << std::endl;
         return; // Ignore other keys after game over
     }
-    if(gameManager->GetActiveSceneName() == GameSceneKindToString(GameSceneKind::AQUARIUM_GAME)){
-        auto gameScene = std::static_pointer_cast<AquariumGameScene>(gameManager->GetActiveScene());
-        switch(key){
-            case OF_KEY_UP:
-                gameScene->GetPlayer()->setDirection(gameScene->GetPlayer()->isXDirectionActive()?gameScene->GetPlayer()->getDx():0, -1);
-                break;
-                case OF_KEY_DOWN:
-                gameScene->GetPlayer()->setDirection(gameScene->GetPlayer()->isXDirectionActive()?gameScene->GetPlayer()->getDx():0, 1);
-                break;
-            case OF_KEY_LEFT:
-                gameScene->GetPlayer()->setDirection(-1, gameScene->GetPlayer()->isYDirectionActive()?gameScene->GetPlayer()->getDy():0);
-                gameScene->GetPlayer()->setFlipped(true);
-                break;
-                case OF_KEY_RIGHT:
-                gameScene->GetPlayer()->setDirection(1, gameScene->GetPlayer()->isYDirectionActive()?gameScene->GetPlayer()->getDy():0);
-                gameScene->GetPlayer()->setFlipped(false);
-                break;
-            default:
-                break;
+    if(key == OF_KEY_F1){
+        showStats = !showStats;
+        return;
+    }
+    if(key == OF_KEY_F2){
+        pacer.CycleMode();
+        return;
+    }
+    if(key == OF_KEY_F3){
+        showMemory = !showMemory;
+        return;
+    }
+    if(key == OF_KEY_F4){
+        if(capture.IsRecording()){
+            capture.Stop();
+        } else {
+            capture.Start(ofGetWidth(), ofGetHeight());
         }
-    
-        
-    
-        gameScene->GetPlayer()->move();
         return;
-
+    }
+    if(gameManager->GetActiveSceneKind() == GameSceneKind::AQUARIUM_GAME){
+        input.KeyPressed(key); // the next tick picks it up, see ofApp::update
+        return;
     }
 
-    if(gameManager->GetActiveSceneName() == GameSceneKindToString(GameSceneKind::GAME_INTRO)){
+    if(gameManager->GetActiveSceneKind() == GameSceneKind::GAME_INTRO){
         switch (key)
         {
         case ' ':
-            gameManager->Transition(GameSceneKindToString(GameSceneKind::AQUARIUM_GAME));
+            gameManager->Transition(GameSceneKind::AQUARIUM_GAME);
             break;
         
         default:
@@ -150,20 +283,8 @@ void ofApp::keyPressed(int key){
 
 //--------------------------------------------------------------
 void ofApp::keyReleased(int key){
-    if(gameManager->GetActiveSceneName() == GameSceneKindToString(GameSceneKind::AQUARIUM_GAME)){
-        auto gameScene = std::static_pointer_cast<AquariumGameScene>(gameManager->GetActiveScene());
-    if( key == OF_KEY_UP || key == OF_KEY_DOWN){
-        gameScene->GetPlayer()->setDirection(gameScene->GetPlayer()->isXDirectionActive()?gameScene->GetPlayer()->getDx():0, 0);
-        gameScene->GetPlayer()->move();
-        return;
-    }
-    
-    if(key == OF_KEY_LEFT || key == OF_KEY_RIGHT){
-        gameScene->GetPlayer()->setDirection(0, gameScene->GetPlayer()->isYDirectionActive()?gameScene->GetPlayer()->getDy():0);
-        gameScene->GetPlayer()->move();
-        return;
-    }
-
+    if(gameManager->GetActiveSceneKind() == GameSceneKind::AQUARIUM_GAME){
+        input.KeyReleased(key);
     }
 }
 
@@ -204,10 +325,11 @@ void ofApp::mouseExited(int x, int y){
 
 //--------------------------------------------------------------
 void ofApp::windowResized(int w, int h){
-    backgroundImage.resize(w, h);
-    auto aquariumScene = std::static_pointer_cast<AquariumGameScene>(gameManager->GetScene(GameSceneKindToString(GameSceneKind::AQUARIUM_GAME)));
-    aquariumScene->GetAquarium()->setBounds(w,h);
-    aquariumScene->GetPlayer()->setBounds(w - 20, h - 20);
+    // the world and the logical screen keep their size, only the projection onto the window changes
+    projection.SetWindowSize(w, h);
+    auto aquariumScene = std::static_pointer_cast<AquariumGameScene>(gameManager->GetScene(GameSceneKind::AQUARIUM_GAME));
+    aquariumScene->GetCamera().SetProjection(projection);
+    staticLayer.Invalidate(); // a few quads repainted at the new scale, no asset is resampled
 
 }
 
@@ -2,6 +2,9 @@
 
 #include "ofMain.h"
 #include "Aquarium.h"
+#include "FramePacer.h"
+#include "FrameCapture.h"
+#include "LoadGovernor.h"
 
 
 class ofApp : public ofBaseApp{
@@ -28,16 +31,51 @@ class ofApp : public ofBaseApp{
 		
 		char moveDirection;
 		int DEFAULT_SPEED = 5;
+		// one screen of the game in world units, whatever the window size. The window only sees it through
+		// the projection, so a resize never touches assets or creatures.
+		static constexpr int VIEW_WIDTH = 1024;
+		static constexpr int VIEW_HEIGHT = 768;
+		int WORLD_SCALE = 1; // the tank is WORLD_SCALE x WORLD_SCALE screens, the camera follows the player (<world_scale>)
+		ViewProjection projection;
 
 
 		AwaitFrames acuariumUpdate{5};
 
+		// the simulation runs in fixed ticks, key events are queued and sampled once per tick
+		InputSampler input;
+		GameSceneKind inputSceneKind = GameSceneKind::GAME_INTRO; // keys are only forwarded in the game, see update
+		float simAccumulator = 0.0f;
+		static constexpr int MAX_TICKS_PER_FRAME = 5; // past this we drop time instead of spiraling
+		bool showStats = false; // F1 toggles the latency and frame time overlay
+
+		FramePacer pacer; // F2 cycles the pacing mode
+		FrameCapture capture; // F4 starts and stops recording to data/capture
+
+		// scales population and effects to hold <target_frame_ms>, fed with what update and draw cost
+		LoadGovernor governor;
+		float simMillis = 0.0f; // this frame's ticks, single threaded path only
+		void applyLoadScale(float drawMillis);
+
+		// with <threaded_sim> on, the game scene ticks on its own thread and draw() only reads its snapshots
+		SimThread simThread;
+		void syncSimThread();
+		void stepSimulation(); // the single threaded path, ticks run here before draw
+
+		// memory accounting, F3 shows the live numbers, a report is appended to memory-report.txt periodically
+		bool showMemory = false;
+		float memoryReportTimer = 0.0f;
+		static constexpr float MEMORY_REPORT_SECONDS = 10.0f;
+		MemoryCharge backgroundMemory;
+
 		ofTrueTypeFont gameOverTitle;
 		GameEvent lastEvent;
 
 
-		ofImage backgroundImage;
-		ofSoundPlayer music; // background music
+		ofTexture backgroundTexture; // GPU only, see LoadTextureOnly
+		CachedLayer staticLayer; // background + the active scene's backdrop, repainted only when they change
+		GameScene* staticLayerScene = nullptr;
+		ofSoundPlayer music; // background music, streamed from disk
+		SfxMixer sfx; // effects triggered by gameplay, see PlaySfx
 
 		std::unique_ptr<GameSceneManager> gameManager;
 		std::shared_ptr<AquariumSpriteManager>spriteManager;
@@ -0,0 +1,101 @@
+#include <random>
+#include "Core.h"
+#include "SelfTest.h"
+
+namespace {
+    // RGBA pixels, opaque where the generator says so
+    template <typename Opaque>
+    ofPixels MakePixels(int width, int height, Opaque opaque) {
+        ofPixels pixels;
+        pixels.allocate(width, height, 4);
+        unsigned char* data = pixels.getData();
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                data[(size_t(y) * width + x) * 4 + 3] = opaque(x, y) ? 255 : 0;
+            }
+        }
+        return pixels;
+    }
+
+    // the same question MasksOverlap answers, one pixel at a time
+    bool ReferenceOverlap(const ofPixels& a, int ax, int ay, bool aFlipped, const ofPixels& b, int bx, int by, bool bFlipped) {
+        auto opaque = [](const ofPixels& pixels, int x, int y, bool flipped) {
+            int width = int(pixels.getWidth());
+            if (x < 0 || y < 0 || x >= width || y >= int(pixels.getHeight())) return false;
+            if (flipped) x = width - 1 - x;
+            return pixels.getData()[(size_t(y) * width + x) * 4 + 3] >= 128;
+        };
+        for (int y = 0; y < int(a.getHeight()); ++y) {
+            for (int x = 0; x < int(a.getWidth()); ++x) {
+                if (opaque(a, x, y, aFlipped) && opaque(b, x + ax - bx, y + ay - by, bFlipped)) return true;
+            }
+        }
+        return false;
+    }
+}
+
+SELF_TEST(CollisionShapeFromPixels) {
+    // a 10x4 block at (20, 6) in a transparent 70x30 image
+    ofPixels pixels = MakePixels(70, 30, [](int x, int y) { return x >= 20 && x < 30 && y >= 6 && y < 10; });
+    auto shape = CollisionShape::FromPixels(pixels);
+    SELF_CHECK(!shape->isEmpty());
+    ofRectangle bounds = shape->getBounds(false);
+    SELF_CHECK(bounds.x == 20 && bounds.y == 6 && bounds.width == 10 && bounds.height == 4);
+    SELF_CHECK(shape->getBounds(true).x == 70 - 30);
+    SELF_CHECK(shape->getCenter(false).x == 25.0f && shape->getCenter(false).y == 8.0f);
+    SELF_CHECK(shape->getCenter(true).x == 45.0f && shape->getCenter(true).y == 8.0f);
+    SELF_CHECK(std::abs(shape->getRadius() - std::sqrt(5.0f * 5.0f + 2.0f * 2.0f)) < 1e-4f);
+
+    auto empty = CollisionShape::FromPixels(MakePixels(16, 16, [](int, int) { return false; }));
+    SELF_CHECK(empty->isEmpty());
+
+    ofPixels solid;
+    solid.allocate(8, 8, 3); // no alpha channel
+    SELF_CHECK(CollisionShape::FromPixels(solid)->getBounds(false).width == 8);
+}
+
+// random masks at offsets all around each other, wider than a word so the shifts cross word boundaries, both
+// flips, against the pixel by pixel answer
+SELF_TEST(CollisionShapeMasksOverlap) {
+    std::mt19937 random(7);
+    const int sizes[][2] = {{13, 9}, {64, 5}, {70, 12}, {130, 7}};
+    int mismatches = 0;
+    int hits = 0;
+    int tests = 0;
+    for (const auto& sizeA : sizes) {
+        for (const auto& sizeB : sizes) {
+            // sparse enough that plenty of overlapping boxes miss
+            ofPixels a = MakePixels(sizeA[0], sizeA[1], [&](int, int) { return random() % 23 == 0; });
+            ofPixels b = MakePixels(sizeB[0], sizeB[1], [&](int, int) { return random() % 19 == 0; });
+            auto shapeA = CollisionShape::FromPixels(a);
+            auto shapeB = CollisionShape::FromPixels(b);
+            for (int i = 0; i < 300; ++i) {
+                int bx = int(random() % (sizeA[0] + sizeB[0] + 2)) - sizeB[0] - 1;
+                int by = int(random() % (sizeA[1] + sizeB[1] + 2)) - sizeB[1] - 1;
+                bool aFlipped = random() % 2;
+                bool bFlipped = random() % 2;
+                bool expected = ReferenceOverlap(a, 0, 0, aFlipped, b, bx, by, bFlipped);
+                bool got = CollisionShape::MasksOverlap(*shapeA, 0, 0, aFlipped, *shapeB, float(bx), float(by), bFlipped);
+                mismatches += expected != got;
+                hits += expected;
+                ++tests;
+                // the same pair seen from b
+                got = CollisionShape::MasksOverlap(*shapeB, float(bx), float(by), bFlipped, *shapeA, 0, 0, aFlipped);
+                mismatches += expected != got;
+            }
+        }
+    }
+    SELF_CHECK(mismatches == 0);
+    SELF_CHECK(hits > tests / 10 && hits < tests - tests / 10); // both answers were exercised
+}
+
+// a hole between two opaque pixels: the bounding boxes overlap but nothing opaque does
+SELF_TEST(CollisionShapeMasksMissInsideBounds) {
+    auto ring = CollisionShape::FromPixels(MakePixels(100, 3, [](int x, int y) { return y == 1 && (x == 0 || x == 99); }));
+    auto dot = CollisionShape::FromPixels(MakePixels(1, 1, [](int, int) { return true; }));
+    SELF_CHECK(!CollisionShape::MasksOverlap(*ring, 0, 0, false, *dot, 50, 1, false));
+    SELF_CHECK(CollisionShape::MasksOverlap(*ring, 0, 0, false, *dot, 99, 1, false));
+    SELF_CHECK(CollisionShape::MasksOverlap(*ring, 0, 0, true, *dot, 0, 1, false));
+    SELF_CHECK(!CollisionShape::MasksOverlap(*ring, 0, 0, false, *dot, 100, 1, false)); // just past the edge
+    SELF_CHECK(CollisionShape::MasksOverlap(*ring, 0, 0, false, *dot, 98.6f, 1.2f, false)); // rounds to (99, 1)
+}
@@ -0,0 +1,58 @@
+#include <cmath>
+#include "Aquarium.h"
+#include "SelfTest.h"
+
+namespace {
+    // moves added one by one round differently from one multiply, by a few ulps each
+    bool Near(float a, float b) { return std::abs(a - b) < 0.01f; }
+
+    // a fish moved step by step and its twin glided the same moves end up together, walls out of reach
+    template <typename Kind>
+    void CheckGlideMatchesSteps(int steps) {
+        PolicyFish<Kind> stepped(1000, 1000, 3, nullptr);
+        PolicyFish<Kind> glided(1000, 1000, 3, nullptr);
+        for (NPCreature* fish : {static_cast<NPCreature*>(&stepped), static_cast<NPCreature*>(&glided)}) {
+            fish->setBounds(2000, 2000);
+            fish->setHeading(0.6f, 0.8f);
+        }
+        for (int round = 0; round < 25; ++round) {
+            Kind::Motion::Step(stepped, nullptr, steps);
+            Kind::Motion::Glide(glided, steps);
+            SELF_CHECK(Near(glided.getX(), stepped.getX()));
+            SELF_CHECK(Near(glided.getY(), stepped.getY()));
+        }
+    }
+}
+
+// the closed-form drift sum and the straight line land where the moves one by one do
+SELF_TEST(FishGlideMatchesSteps) {
+    CheckGlideMatchesSteps<SlowfishKind>(4);
+    CheckGlideMatchesSteps<ZaggyFishKind>(4);
+    CheckGlideMatchesSteps<BaseFishKind>(3);
+}
+
+// a glide that runs into walls comes back off them, turned around once per wall
+SELF_TEST(FishGlideFoldsOffWalls) {
+    using Motion = BaseFishKind::Motion;
+    BaseFish right(990, 50, 5, nullptr);
+    right.setBounds(1000, 100);
+    right.setHeading(1, 0);
+    Motion::Glide(right, 4); // 20 past x 990 is 10 short of the wall coming back
+    SELF_CHECK(Near(right.getX(), 990));
+    SELF_CHECK(Motion::Velocity(right).x < 0);
+
+    BaseFish left(10, 50, 5, nullptr);
+    left.setBounds(1000, 100);
+    left.setHeading(-1, 0);
+    Motion::Glide(left, 4);
+    SELF_CHECK(Near(left.getX(), 10));
+    SELF_CHECK(Motion::Velocity(left).x > 0);
+
+    BaseFish both(50, 50, 40, nullptr);
+    both.setBounds(100, 100);
+    both.setHeading(1, 0);
+    Motion::Glide(both, 4); // 160 to the right: off the right wall, off the left, 10 in
+    SELF_CHECK(Near(both.getX(), 10));
+    SELF_CHECK(Motion::Velocity(both).x > 0);
+    SELF_CHECK(Near(both.getY(), 50));
+}
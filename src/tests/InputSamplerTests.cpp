@@ -0,0 +1,55 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "SelfTest.h"
+#include "SimThread.h"
+
+namespace {
+    constexpr uint32_t kUp = 1u << static_cast<int>(InputKey::UP);
+    constexpr uint32_t kLeft = 1u << static_cast<int>(InputKey::LEFT);
+}
+
+// a press and release that both land before one tick still hold the key for that tick, the release goes to the next
+SELF_TEST(InputSamplerTapBetweenTicks) {
+    InputSampler input;
+    input.KeyPressed(OF_KEY_UP);
+    input.KeyPressed(OF_KEY_LEFT);
+    input.KeyReleased(OF_KEY_UP);
+    InputFrame first = input.ConsumeTick();
+    SELF_CHECK(first.held == (kUp | kLeft) && first.changed);
+    InputFrame second = input.ConsumeTick();
+    SELF_CHECK(second.held == kLeft && second.changed);
+    InputFrame third = input.ConsumeTick();
+    SELF_CHECK(third.held == kLeft && !third.changed);
+    SELF_CHECK(input.GetInputToSim().Count() == 3);
+}
+
+// edges forwarded to the sim thread are applied in order, a tap included, and come back once a tick took them
+SELF_TEST(SimThreadAppliesEveryEdge) {
+    SimThread sim;
+    std::vector<uint32_t> seen; // sim thread until Stop
+    sim.Start([&seen](const InputFrame& frame) {
+        if (frame.changed) seen.push_back(frame.held);
+        return true;
+    });
+    SELF_CHECK(sim.PushInput({InputKey::UP, true, 1}));
+    SELF_CHECK(sim.PushInput({InputKey::UP, false, 2}));
+    SELF_CHECK(sim.PushInput({InputKey::LEFT, true, 3}));
+
+    std::vector<uint64_t> stamps;
+    auto giveUp = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (stamps.size() < 3 && std::chrono::steady_clock::now() < giveUp) {
+        InputEdge edge;
+        uint64_t consumedMicros;
+        while (sim.PopConsumed(edge, consumedMicros)) {
+            SELF_CHECK(consumedMicros >= edge.stampMicros);
+            stamps.push_back(edge.stampMicros);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    sim.Stop();
+    std::vector<uint64_t> expectedStamps = {1, 2, 3};
+    SELF_CHECK(stamps == expectedStamps);
+    std::vector<uint32_t> expectedHeld = {kUp, kLeft}; // the release and the next press share a tick
+    SELF_CHECK(seen == expectedHeld);
+}
@@ -0,0 +1,110 @@
+#include <thread>
+#include "SelfTest.h"
+#include "SimThread.h"
+
+namespace {
+    // big enough that a torn copy would show, every field holds the same sequence number
+    struct Frame {
+        std::array<uint64_t, 32> fields{};
+        void Fill(uint64_t sequence) { fields.fill(sequence); }
+        bool IsWhole() const {
+            for (uint64_t field : fields) {
+                if (field != fields[0]) return false;
+            }
+            return true;
+        }
+    };
+}
+
+SELF_TEST(TripleBufferLatestValue) {
+    TripleBuffer<int> buffer;
+    buffer.Back() = 1;
+    buffer.Publish();
+    SELF_CHECK(buffer.Read() == 1);
+    SELF_CHECK(buffer.Read() == 1); // no new publish, same slot
+
+    for (int value = 2; value <= 5; ++value) {
+        buffer.Back() = value;
+        buffer.Publish();
+    }
+    const int& held = buffer.Read();
+    SELF_CHECK(held == 5); // the ones in between were never seen, that's the point
+
+    // the writer keeps going, the slot the reader holds is never handed back to it
+    for (int value = 6; value <= 20; ++value) {
+        buffer.Back() = value;
+        buffer.Publish();
+        SELF_CHECK(held == 5);
+    }
+    SELF_CHECK(buffer.Read() == 20);
+}
+
+// a writer thread publishing as fast as it can and a reader that only ever sees whole frames, in order
+SELF_TEST(TripleBufferConcurrent) {
+    TripleBuffer<Frame> buffer;
+    constexpr uint64_t kFrames = 200000;
+    std::thread writer([&buffer]() {
+        for (uint64_t sequence = 1; sequence <= kFrames; ++sequence) {
+            buffer.Back().Fill(sequence);
+            buffer.Publish();
+        }
+    });
+    uint64_t last = 0;
+    int torn = 0;
+    int backwards = 0;
+    while (last < kFrames) {
+        const Frame& frame = buffer.Read();
+        torn += !frame.IsWhole();
+        backwards += frame.fields[0] < last;
+        last = frame.fields[0];
+        std::this_thread::yield();
+    }
+    writer.join();
+    SELF_CHECK(torn == 0);
+    SELF_CHECK(backwards == 0);
+}
+
+SELF_TEST(SpscQueueBounds) {
+    SpscQueue<int, 4> queue;
+    int value = -1;
+    SELF_CHECK(!queue.Pop(value));
+    // around the ring several times so the indices wrap past the capacity
+    for (int round = 0; round < 5; ++round) {
+        for (int i = 0; i < 4; ++i) {
+            SELF_CHECK(queue.Push(round * 10 + i));
+        }
+        SELF_CHECK(!queue.Push(99)); // full, fails instead of blocking or overwriting
+        for (int i = 0; i < 4; ++i) {
+            SELF_CHECK(queue.Pop(value) && value == round * 10 + i);
+        }
+        SELF_CHECK(!queue.Pop(value));
+    }
+}
+
+// everything pushed on one thread comes out on the other, once and in order
+SELF_TEST(SpscQueueConcurrent) {
+    SpscQueue<uint64_t, 64> queue;
+    constexpr uint64_t kItems = 200000;
+    std::thread producer([&queue]() {
+        for (uint64_t item = 0; item < kItems; ++item) {
+            while (!queue.Push(item)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    uint64_t expected = 0;
+    int outOfOrder = 0;
+    while (expected < kItems) {
+        uint64_t item;
+        if (!queue.Pop(item)) {
+            std::this_thread::yield();
+            continue;
+        }
+        outOfOrder += item != expected;
+        expected = item + 1;
+    }
+    producer.join();
+    uint64_t extra;
+    SELF_CHECK(outOfOrder == 0);
+    SELF_CHECK(!queue.Pop(extra));
+}
@@ -0,0 +1,75 @@
+#include <cmath>
+#include "Core.h"
+#include "SelfTest.h"
+
+namespace {
+    // a headless creature, it collides as a circle at its position
+    class Body : public Creature {
+    public:
+        Body(float x, float y, float radius) : Creature(x, y, 0, radius, 0, nullptr) {}
+        void move() override {}
+        void draw() const override {}
+        void moveTo(float x, float y) { m_x = x; m_y = y; }
+    };
+
+    // the body starts the check interval at from and ends it at to
+    void Sweep(Body& body, float fromX, float fromY, float toX, float toY) {
+        body.moveTo(fromX, fromY);
+        body.beginSweep();
+        body.moveTo(toX, toY);
+    }
+
+    bool Near(float a, float b) { return std::abs(a - b) < 1e-4f; }
+}
+
+// a fast mover passes clean through a small target between two checks, the sweep still finds the contact
+SELF_TEST(SweepCollisionTunneling) {
+    Body target(0, 0, 10);
+    target.beginSweep();
+    Body bullet(0, 0, 5);
+    Sweep(bullet, -100, 0, 100, 0);
+    SELF_CHECK(!checkCollision(target, bullet));
+    float t = sweepCollision(target, bullet);
+    SELF_CHECK(Near(t, (100.0f - 15.0f) / 200.0f));
+    SELF_CHECK(Near(sweepCollision(bullet, target), t)); // symmetric
+
+    bullet.rewindSweep(t);
+    SELF_CHECK(Near(bullet.getX(), -15.0f)); // rewound to the contact point
+    SELF_CHECK(checkCollision(target, bullet));
+}
+
+SELF_TEST(SweepCollisionBothMoving) {
+    Body a(0, 0, 5);
+    Body b(0, 0, 5);
+    Sweep(a, 0, 0, 100, 0);
+    Sweep(b, 100, 0, 0, 0);
+    SELF_CHECK(Near(sweepCollision(a, b), 0.45f)); // closing at 200 per interval, 90 to cover
+
+    // same velocity, the gap never closes
+    Sweep(a, 0, 0, 100, 0);
+    Sweep(b, 30, 0, 130, 0);
+    SELF_CHECK(sweepCollision(a, b) < 0.0f);
+}
+
+SELF_TEST(SweepCollisionMisses) {
+    Body target(0, 0, 10);
+    target.beginSweep();
+    Body mover(0, 0, 5);
+    Sweep(mover, -100, 50, 100, 50); // passes 50 away, the circles need 15
+    SELF_CHECK(sweepCollision(target, mover) < 0.0f);
+    Sweep(mover, -100, 0, -40, 0); // heading straight at it, would touch at t = 1.42
+    SELF_CHECK(sweepCollision(target, mover) < 0.0f);
+    Sweep(mover, -14, 0, -100, 0); // touching at the start and moving away still counts, at 0
+    SELF_CHECK(sweepCollision(target, mover) == 0.0f);
+}
+
+SELF_TEST(SweepCollisionStill) {
+    Body a(0, 0, 10);
+    Body b(30, 0, 10);
+    a.beginSweep();
+    b.beginSweep();
+    SELF_CHECK(sweepCollision(a, b) < 0.0f);
+    Sweep(b, 15, 0, 15, 0);
+    SELF_CHECK(sweepCollision(a, b) == 0.0f);
+    SELF_CHECK(sweepCollision(a, b, false) == 0.0f); // no masks, pixelAccurate changes nothing
+}
@@ -0,0 +1,195 @@
+#include <sstream>
+#include "SelfTest.h"
+#include "TimerWheel.h"
+
+namespace {
+    struct Fired {
+        uint64_t tick;
+        uint16_t kind;
+        uint64_t payload;
+        bool operator==(const Fired& other) const { return tick == other.tick && kind == other.kind && payload == other.payload; }
+    };
+
+    // records every firing of kinds 0..kinds-1 as (tick, kind, payload)
+    void RecordKinds(TimerWheel& wheel, std::vector<Fired>& fired, uint16_t kinds) {
+        for (uint16_t kind = 0; kind < kinds; ++kind) {
+            wheel.SetHandler(kind, [&wheel, &fired, kind](TimerHandle, uint64_t payload) {
+                fired.push_back({wheel.GetTick(), kind, payload});
+            });
+        }
+    }
+}
+
+// delays on either side of every level boundary fire on exactly their tick, after cascading down
+SELF_TEST(TimerWheelLongDelays) {
+    const uint64_t delays[] = {1, 2, 255, 256, 257, 511, 65535, 65536, 65537, 70000, 16777215, 16777216, 16777217, 16777216 + 65536 + 3};
+    TimerWheel wheel;
+    std::vector<Fired> fired;
+    RecordKinds(wheel, fired, 1);
+    // start off a boundary too, so the windows don't line up with the delays
+    for (int i = 0; i < 300; ++i) wheel.Advance();
+    uint64_t start = wheel.GetTick();
+    std::vector<TimerHandle> timers;
+    for (uint64_t delay : delays) {
+        timers.push_back(wheel.Schedule(delay, 0, delay));
+        SELF_CHECK(wheel.GetRemaining(timers.back()) == delay);
+    }
+    uint64_t last = delays[std::size(delays) - 1];
+    while (wheel.GetTick() < start + last) {
+        wheel.Advance();
+        if (wheel.GetTick() == start + 65536) {
+            SELF_CHECK(wheel.GetRemaining(timers.back()) == last - 65536); // still counting right after cascades
+        }
+    }
+    SELF_CHECK(fired.size() == std::size(delays));
+    for (const Fired& firing : fired) {
+        SELF_CHECK(firing.tick == start + firing.payload);
+    }
+    SELF_CHECK(wheel.GetPendingCount() == 0);
+}
+
+SELF_TEST(TimerWheelPeriodic) {
+    TimerWheel wheel;
+    std::vector<Fired> fired;
+    RecordKinds(wheel, fired, 1);
+    wheel.Schedule(10, 0, 0, 300); // every period crosses a level 0 wrap
+    for (int i = 0; i < 10 + 300 * 4; ++i) wheel.Advance();
+    SELF_CHECK(fired.size() == 5);
+    for (size_t i = 0; i < fired.size(); ++i) {
+        SELF_CHECK(fired[i].tick == 10 + 300 * i);
+    }
+}
+
+// a handler may cancel timers due on the same tick (behind it in the slot), later ones, and itself
+SELF_TEST(TimerWheelCancelDuringAdvance) {
+    TimerWheel wheel;
+    std::vector<Fired> fired;
+    TimerHandle sameTick, later, periodic;
+    wheel.SetHandler(0, [&](TimerHandle, uint64_t payload) {
+        fired.push_back({wheel.GetTick(), 0, payload});
+        wheel.Cancel(sameTick);
+        wheel.Cancel(later);
+    });
+    wheel.SetHandler(1, [&](TimerHandle, uint64_t payload) { fired.push_back({wheel.GetTick(), 1, payload}); });
+    wheel.SetHandler(2, [&](TimerHandle timer, uint64_t payload) {
+        fired.push_back({wheel.GetTick(), 2, payload});
+        if (fired.size() >= 3) wheel.Cancel(timer); // the handle it got is the one that stays pending
+    });
+
+    wheel.Schedule(5, 0, 100);
+    sameTick = wheel.Schedule(5, 1, 101);
+    later = wheel.Schedule(600, 1, 102);
+    periodic = wheel.Schedule(6, 2, 103, 1);
+    for (int i = 0; i < 700; ++i) wheel.Advance();
+
+    std::vector<Fired> expected = {{5, 0, 100}, {6, 2, 103}, {7, 2, 103}};
+    SELF_CHECK(fired == expected);
+    SELF_CHECK(!sameTick.IsSet() && !later.IsSet());
+    SELF_CHECK(!wheel.IsPending(periodic));
+    SELF_CHECK(wheel.GetPendingCount() == 0);
+}
+
+// a timer scheduled from a handler never fires in the Advance that scheduled it
+SELF_TEST(TimerWheelScheduleDuringAdvance) {
+    TimerWheel wheel;
+    std::vector<Fired> fired;
+    wheel.SetHandler(0, [&](TimerHandle, uint64_t payload) {
+        fired.push_back({wheel.GetTick(), 0, payload});
+        if (payload < 3) wheel.Schedule(1, 0, payload + 1);
+    });
+    wheel.Schedule(255, 0, 0); // the chain crosses the level 0 wrap
+    for (int i = 0; i < 300; ++i) wheel.Advance();
+    std::vector<Fired> expected = {{255, 0, 0}, {256, 0, 1}, {257, 0, 2}, {258, 0, 3}};
+    SELF_CHECK(fired == expected);
+}
+
+// a wheel saved mid-run and loaded elsewhere fires the same timers on the same ticks in the same order, and
+// handles taken before the save still work on the loaded wheel
+SELF_TEST(TimerWheelSaveLoadAdvance) {
+    TimerWheel original;
+    std::vector<Fired> originalFired;
+    RecordKinds(original, originalFired, 3);
+    std::vector<TimerHandle> handles;
+    for (uint64_t i = 0; i < 200; ++i) {
+        uint64_t delay = 1 + (i * 7919) % 90000;
+        handles.push_back(original.Schedule(delay, uint16_t(i % 3), i, i % 5 == 0 ? 1 + i % 700 : 0));
+    }
+    for (int i = 0; i < 12; ++i) handles.push_back(original.Schedule(40, 1, 1000 + i)); // same tick, order matters
+    for (size_t i = 0; i < handles.size(); i += 9) original.Cancel(handles[i]);
+    for (int i = 0; i < 1000; ++i) original.Advance();
+
+    std::stringstream saved;
+    original.Save(saved);
+    TimerWheel loaded;
+    std::vector<Fired> loadedFired;
+    RecordKinds(loaded, loadedFired, 3);
+    SELF_CHECK(loaded.Load(saved));
+    SELF_CHECK(loaded.GetTick() == original.GetTick());
+    SELF_CHECK(loaded.GetPendingCount() == original.GetPendingCount());
+    for (const TimerHandle& handle : handles) {
+        SELF_CHECK(loaded.IsPending(handle) == original.IsPending(handle));
+        SELF_CHECK(loaded.GetRemaining(handle) == original.GetRemaining(handle));
+    }
+
+    // both go on the same way, cancels by old handles included
+    originalFired.clear();
+    for (size_t i = 1; i < handles.size(); i += 11) {
+        TimerHandle copy = handles[i];
+        original.Cancel(handles[i]);
+        loaded.Cancel(copy);
+    }
+    for (int i = 0; i < 100000; ++i) {
+        original.Advance();
+        loaded.Advance();
+    }
+    SELF_CHECK(!originalFired.empty());
+    SELF_CHECK(loadedFired == originalFired);
+    SELF_CHECK(loaded.GetPendingCount() == original.GetPendingCount());
+
+    // and new timers reuse the same pool slots
+    TimerHandle a = original.Schedule(3, 0);
+    TimerHandle b = loaded.Schedule(3, 0);
+    SELF_CHECK(a.index == b.index && a.generation == b.generation);
+}
+
+// a copy is a snapshot: it and the original go on independently, each firing what it had pending
+SELF_TEST(TimerWheelCopy) {
+    TimerWheel original;
+    std::vector<Fired> originalFired;
+    RecordKinds(original, originalFired, 1);
+    std::vector<TimerHandle> handles;
+    for (uint64_t i = 0; i < 50; ++i) {
+        handles.push_back(original.Schedule(1 + (i * 977) % 70000, 0, i));
+    }
+    for (int i = 0; i < 300; ++i) original.Advance();
+
+    TimerWheel copy = original;
+    std::vector<Fired> copyFired;
+    RecordKinds(copy, copyFired, 1); // otherwise the copy would record into the original's list
+    size_t pending = copy.GetPendingCount();
+    size_t cancelled = 0;
+    originalFired.clear();
+    for (size_t i = 0; i < handles.size(); i += 2) {
+        if (original.IsPending(handles[i])) ++cancelled;
+        original.Cancel(handles[i]); // unlinks from the original's slots only
+    }
+    SELF_CHECK(copy.GetPendingCount() == pending);
+    for (int i = 0; i < 70000; ++i) {
+        original.Advance();
+        copy.Advance();
+    }
+    SELF_CHECK(copy.GetPendingCount() == 0 && original.GetPendingCount() == 0);
+    SELF_CHECK(copyFired.size() == pending);
+    SELF_CHECK(originalFired.size() == pending - cancelled);
+    for (const Fired& firing : originalFired) {
+        SELF_CHECK(firing.payload % 2 == 1);
+    }
+}
+
+SELF_TEST(TimerWheelLoadRejectsGarbage) {
+    TimerWheel wheel;
+    wheel.Schedule(10, 0);
+    std::stringstream garbage("not a wheel");
+    SELF_CHECK(!wheel.Load(garbage));
+    SELF_CHECK(wheel.GetPendingCount() == 0 && wheel.GetTick() == 0);
+}